@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//Timing, allocation counting and JSON output for the bench target.
+//bench.cpp replaces the global operator new so every heap allocation on the
+//benchmark thread bumps allocationCount().
+
+namespace bench {
+
+uint64_t allocationCount();
+
+//Keeps a benchmarked result alive so the work producing it is not optimised away
+inline volatile uint64_t consumed = 0;
+inline void consume(uint64_t value) { consumed = value; }
+
+inline uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+    std::string name;
+    std::string group; //"micro" or "macro"
+    uint64_t depth = 0; //Resting orders per side (micro) or symbols (macro)
+    uint64_t ops = 0;
+    double ops_per_sec = 0.0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+    double allocs_per_op = 0.0;
+};
+
+//Times operations one at a time; setup work between them stays outside the samples
+class Recorder {
+public:
+    explicit Recorder(size_t expected_ops) { samples_.reserve(expected_ops); }
+
+    template <typename Op>
+    void time(Op&& op) {
+        uint64_t allocations = allocationCount();
+        uint64_t start = nowNs();
+        op();
+        uint64_t end = nowNs();
+        allocations_ += allocationCount() - allocations;
+        samples_.push_back(end - start);
+    }
+
+    //Throughput counts `ops_per_sample` operations per timed call (batched APIs)
+    Result summarize(const std::string& name, const std::string& group, uint64_t depth,
+                     uint64_t ops_per_sample = 1) {
+        Result result;
+        result.name = name;
+        result.group = group;
+        result.depth = depth;
+        result.ops = samples_.size() * ops_per_sample;
+        if (samples_.empty()) {
+            return result;
+        }
+        uint64_t total = 0;
+        for (uint64_t sample : samples_) total += sample;
+        std::sort(samples_.begin(), samples_.end());
+        auto percentile = [this](double p) {
+            size_t index = static_cast<size_t>(p * static_cast<double>(samples_.size() - 1) + 0.5);
+            return samples_[index];
+        };
+        result.ops_per_sec = total > 0 ? result.ops * 1e9 / static_cast<double>(total) : 0.0;
+        result.mean_ns = static_cast<double>(total) / static_cast<double>(samples_.size());
+        result.p50_ns = percentile(0.50);
+        result.p99_ns = percentile(0.99);
+        result.p999_ns = percentile(0.999);
+        result.max_ns = samples_.back();
+        result.allocs_per_op = static_cast<double>(allocations_) / static_cast<double>(result.ops);
+        return result;
+    }
+
+private:
+    std::vector<uint64_t> samples_;
+    uint64_t allocations_ = 0;
+};
+
+//Cost of one empty Recorder::time() call, so readers can judge sub-100ns results
+inline uint64_t timerOverheadNs() {
+    Recorder recorder(100000);
+    for (int i = 0; i < 100000; i++) {
+        recorder.time([] {});
+    }
+    return recorder.summarize("timer", "", 0).p50_ns;
+}
+
+inline std::string toJson(const std::vector<Result>& results, uint64_t timer_overhead_ns) {
+    std::string json = "{\n  \"timer_overhead_ns\": " + std::to_string(timer_overhead_ns) + ",\n  \"benchmarks\": [";
+    char line[512];
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::snprintf(line, sizeof(line),
+                      "%s\n    {\"name\": \"%s\", \"group\": \"%s\", \"depth\": %llu, \"ops\": %llu, "
+                      "\"ops_per_sec\": %.1f, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+                      "\"p999_ns\": %llu, \"max_ns\": %llu, \"allocs_per_op\": %.4f}",
+                      i == 0 ? "" : ",", r.name.c_str(), r.group.c_str(),
+                      static_cast<unsigned long long>(r.depth), static_cast<unsigned long long>(r.ops),
+                      r.ops_per_sec, r.mean_ns,
+                      static_cast<unsigned long long>(r.p50_ns), static_cast<unsigned long long>(r.p99_ns),
+                      static_cast<unsigned long long>(r.p999_ns), static_cast<unsigned long long>(r.max_ns),
+                      r.allocs_per_op);
+        json += line;
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+} // namespace bench
@@ -0,0 +1,331 @@
+#include "BenchHarness.hpp"
+#include "OrderBook.hpp"
+#include "OrderBookManager.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+
+//Matching engine benchmarks. Prints one JSON document (see BenchHarness.hpp).
+//Usage: bench [--quick] [--filter <substring>] [--out <file>]
+//
+//Micro: single-book operations at several resting depths, kept at that depth by
+//untimed setup between samples. Macro: synthetic order flow through OrderBookManager.
+
+//------------ Allocation counting ----------------
+
+static thread_local uint64_t thread_allocations = 0;
+
+void* operator new(std::size_t size) {
+    thread_allocations++;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+uint64_t bench::allocationCount() { return thread_allocations; }
+
+using bench::Recorder;
+using bench::Result;
+
+namespace {
+
+constexpr SymbolId SYMBOL = 1;
+constexpr Price MID_TICKS = 10000; //100.00 at a 0.01 tick
+constexpr double TICK = 0.01;
+
+//------------ Micro benchmarks ----------------
+
+//One book holding `depth` orders per side over up to 500 levels either side of the mid
+class BookFixture {
+public:
+    BookFixture(size_t depth, MatchingMode mode)
+        : book_(SYMBOL, "BENCH", TICK), levels_(std::max<size_t>(1, std::min<size_t>(depth, 500))),
+          next_id_(1), rng_(depth) {
+        book_.setMatchingMode(mode);
+        for (size_t i = 0; i < depth; i++) {
+            bid_ids_.push_back(rest(Side::BUY, bidPrice(i % levels_), 10));
+            ask_ids_.push_back(rest(Side::SELL, askPrice(i % levels_), 10));
+        }
+    }
+
+    OrderBook& book() { return book_; }
+    OrderId nextId() { return next_id_++; }
+    size_t levels() const { return levels_; }
+    std::mt19937_64& rng() { return rng_; }
+    std::vector<OrderId>& bidIds() { return bid_ids_; }
+
+    static double bidPrice(size_t level) { return (MID_TICKS - 1 - static_cast<Price>(level)) * TICK; }
+    static double askPrice(size_t level) { return (MID_TICKS + 1 + static_cast<Price>(level)) * TICK; }
+
+    OrderId rest(Side side, double price, int quantity) {
+        OrderId id = nextId();
+        book_.submitOrder(Order(id, 1, SYMBOL, side, price, quantity));
+        return id;
+    }
+
+    //Puts back the resting side of each trade so the book keeps its depth
+    void replenish(const std::vector<Trade>& trades, Side aggressor) {
+        Side resting = aggressor == Side::BUY ? Side::SELL : Side::BUY;
+        for (const Trade& trade : trades) {
+            rest(resting, trade.price, trade.quantity);
+        }
+    }
+
+private:
+    OrderBook book_;
+    size_t levels_;
+    OrderId next_id_;
+    std::mt19937_64 rng_;
+    std::vector<OrderId> bid_ids_;
+    std::vector<OrderId> ask_ids_;
+};
+
+Result benchAddOrder(size_t depth, size_t ops) {
+    BookFixture fixture(depth, MatchingMode::CONTINUOUS);
+    Recorder recorder(ops);
+    for (size_t i = 0; i < ops; i++) {
+        OrderId id = fixture.nextId();
+        Order order(id, 1, SYMBOL, Side::BUY, BookFixture::bidPrice(fixture.rng()() % fixture.levels()), 10);
+        recorder.time([&] { fixture.book().submitOrder(order); });
+        fixture.book().tryCancelOrder(id);
+    }
+    return recorder.summarize("add_order", "micro", depth);
+}
+
+Result benchCancelOrder(size_t depth, size_t ops) {
+    BookFixture fixture(depth, MatchingMode::CONTINUOUS);
+    std::vector<OrderId>& ids = fixture.bidIds();
+    Recorder recorder(ops);
+    for (size_t i = 0; i < ops; i++) {
+        size_t slot = fixture.rng()() % ids.size();
+        const Order* order = fixture.book().getOrder(ids[slot]);
+        double price = order->price;
+        recorder.time([&] { fixture.book().tryCancelOrder(ids[slot]); });
+        ids[slot] = fixture.rest(Side::BUY, price, 10);
+    }
+    return recorder.summarize("cancel_order", "micro", depth);
+}
+
+//Batch mode: a crossing buy rests untimed, the timed pass uncrosses and drains the trades
+Result benchMatchOrders(size_t depth, size_t ops) {
+    BookFixture fixture(depth, MatchingMode::BATCH);
+    Recorder recorder(ops);
+    std::vector<Trade> trades;
+    for (size_t i = 0; i < ops; i++) {
+        OrderId id = fixture.nextId();
+        fixture.book().submitOrder(Order(id, 2, SYMBOL, Side::BUY, fixture.book().getBestAsk(), 5));
+        recorder.time([&] { trades = fixture.book().matchOrders(); });
+        fixture.replenish(trades, Side::BUY);
+        fixture.book().tryCancelOrder(id); //Remainder, if the touch was thinner than 5
+    }
+    return recorder.summarize("match_orders", "micro", depth);
+}
+
+Result benchMarketOrder(size_t depth, size_t ops) {
+    BookFixture fixture(depth, MatchingMode::CONTINUOUS);
+    Recorder recorder(ops);
+    for (size_t i = 0; i < ops; i++) {
+        Side side = i % 2 == 0 ? Side::BUY : Side::SELL;
+        Order order(fixture.nextId(), 2, SYMBOL, side, 0.0, 25, OrderType::MARKET);
+        recorder.time([&] { fixture.book().submitOrder(order); });
+        fixture.replenish(fixture.book().matchOrders(), side);
+    }
+    return recorder.summarize("market_order", "micro", depth);
+}
+
+Result benchDepthQuery(size_t depth, size_t ops) {
+    BookFixture fixture(depth, MatchingMode::CONTINUOUS);
+    Recorder recorder(ops);
+    size_t levels = 0;
+    for (size_t i = 0; i < ops; i++) {
+        recorder.time([&] { levels += fixture.book().getBidDepth(10).size(); });
+    }
+    bench::consume(levels);
+    return recorder.summarize("get_bid_depth_10", "micro", depth);
+}
+
+Result benchCopyDepth(size_t depth, size_t ops) {
+    BookFixture fixture(depth, MatchingMode::CONTINUOUS);
+    Recorder recorder(ops);
+    double prices[10];
+    int quantities[10];
+    for (size_t i = 0; i < ops; i++) {
+        recorder.time([&] { fixture.book().copyBidDepth(10, prices, quantities); });
+    }
+    bench::consume(quantities[0]);
+    return recorder.summarize("copy_bid_depth_10", "micro", depth);
+}
+
+Result benchTradeId(size_t ops) {
+    Recorder recorder(ops);
+    const std::string symbol = "BENCH";
+    size_t length = 0;
+    for (size_t i = 0; i < ops; i++) {
+        recorder.time([&] { length += formatTradeId(makeTradeId(SYMBOL, i + 1), symbol).size(); });
+    }
+    bench::consume(length);
+    return recorder.summarize("format_trade_id", "micro", 0);
+}
+
+//------------ Macro benchmarks ----------------
+
+enum class FlowKind : uint8_t { LIMIT, MARKET, CANCEL };
+
+struct FlowMessage {
+    FlowKind kind;
+    Order order; //Cancels use symbol and order_id
+};
+
+//60% limits within 10 ticks of the mid, 30% cancels of earlier limits, 10% market orders
+std::vector<FlowMessage> makeFlow(size_t symbols, size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<FlowMessage> flow;
+    flow.reserve(count);
+    std::vector<std::pair<SymbolId, OrderId>> placed;
+    OrderId next_id = 1;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t roll = rng() % 100;
+        SymbolId symbol = static_cast<SymbolId>(1 + rng() % symbols);
+        Side side = rng() % 2 == 0 ? Side::BUY : Side::SELL;
+        int quantity = static_cast<int>(1 + rng() % 10);
+        if (roll < 30 && !placed.empty()) {
+            auto target = placed[rng() % placed.size()];
+            Order cancel(target.second, 0, target.first, Side::BUY, 1.0, 1);
+            flow.push_back({FlowKind::CANCEL, cancel});
+        } else if (roll < 40) {
+            flow.push_back({FlowKind::MARKET, Order(next_id++, 1, symbol, side, 0.0, quantity, OrderType::MARKET)});
+        } else {
+            Price offset = static_cast<Price>(rng() % 10);
+            Price ticks = side == Side::BUY ? MID_TICKS - offset : MID_TICKS + offset;
+            flow.push_back({FlowKind::LIMIT, Order(next_id, 1, symbol, side, ticks * TICK, quantity)});
+            placed.emplace_back(symbol, next_id++);
+        }
+    }
+    return flow;
+}
+
+std::unique_ptr<OrderBookManager> makeManager(size_t symbols, MatchingMode mode) {
+    auto manager = std::make_unique<OrderBookManager>();
+    manager->setClock(std::make_unique<BatchClock>());
+    for (size_t i = 0; i < symbols; i++) {
+        SymbolId id = manager->addOrderBook("S" + std::to_string(i), TICK);
+        manager->setMatchingMode(id, mode);
+    }
+    return manager;
+}
+
+//Per-message submit/cancel latency with a matching pass every `pass_every` messages
+void benchManagerFlow(const std::string& name, MatchingMode mode, size_t symbols,
+                      const std::vector<FlowMessage>& flow, size_t pass_every, std::vector<Result>& results) {
+    auto manager = makeManager(symbols, mode);
+    Recorder messages(flow.size());
+    Recorder passes(flow.size() / pass_every + 1);
+    for (size_t i = 0; i < flow.size(); i++) {
+        const FlowMessage& message = flow[i];
+        if (message.kind == FlowKind::CANCEL) {
+            messages.time([&] { manager->tryCancelOrder(message.order.symbol, message.order.order_id); });
+        } else {
+            messages.time([&] { manager->submitOrder(message.order); });
+        }
+        if ((i + 1) % pass_every == 0) {
+            passes.time([&] { manager->processOrdersByBook(); });
+        }
+    }
+    results.push_back(messages.summarize(name, "macro", symbols));
+    results.push_back(passes.summarize(name + "_pass", "macro", symbols));
+}
+
+//The batch API: one submitOrders/tryCancelOrders call per chunk, then a pass; one sample per chunk
+void benchManagerBatchApi(size_t symbols, const std::vector<FlowMessage>& flow, size_t chunk,
+                          std::vector<Result>& results) {
+    auto manager = makeManager(symbols, MatchingMode::BATCH);
+    std::vector<Order> orders;
+    std::vector<SubmitResult> submitted(chunk);
+    std::vector<SymbolId> cancel_symbols;
+    std::vector<OrderId> cancel_ids;
+    std::unique_ptr<bool[]> cancelled(new bool[chunk]);
+    Recorder chunks(flow.size() / chunk + 1);
+
+    for (size_t start = 0; start + chunk <= flow.size(); start += chunk) {
+        orders.clear();
+        cancel_symbols.clear();
+        cancel_ids.clear();
+        for (size_t i = start; i < start + chunk; i++) {
+            if (flow[i].kind == FlowKind::CANCEL) {
+                cancel_symbols.push_back(flow[i].order.symbol);
+                cancel_ids.push_back(flow[i].order.order_id);
+            } else {
+                orders.push_back(flow[i].order);
+            }
+        }
+        chunks.time([&] {
+            manager->submitOrders(orders.data(), orders.size(), submitted.data());
+            manager->tryCancelOrders(cancel_symbols.data(), cancel_ids.data(), cancel_ids.size(), cancelled.get());
+            manager->processOrdersByBook();
+        });
+    }
+    results.push_back(chunks.summarize("manager_batch_api", "macro", symbols, chunk));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    std::string filter;
+    std::string out_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            quick = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--quick] [--filter <substring>] [--out <file>]\n";
+            return 2;
+        }
+    }
+
+    const size_t micro_ops = quick ? 20000 : 200000;
+    const size_t flow_messages = quick ? 200000 : 2000000;
+    const std::vector<size_t> depths = {10, 1000, 100000};
+    auto wanted = [&filter](const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+
+    std::vector<Result> results;
+    for (size_t depth : depths) {
+        if (wanted("add_order")) results.push_back(benchAddOrder(depth, micro_ops));
+        if (wanted("cancel_order")) results.push_back(benchCancelOrder(depth, micro_ops));
+        if (wanted("match_orders")) results.push_back(benchMatchOrders(depth, micro_ops));
+        if (wanted("market_order")) results.push_back(benchMarketOrder(depth, micro_ops));
+        if (wanted("get_bid_depth")) results.push_back(benchDepthQuery(depth, micro_ops));
+        if (wanted("copy_bid_depth")) results.push_back(benchCopyDepth(depth, micro_ops));
+    }
+    if (wanted("format_trade_id")) results.push_back(benchTradeId(micro_ops));
+
+    for (size_t symbols : {size_t(1), size_t(64)}) {
+        std::vector<FlowMessage> flow = makeFlow(symbols, flow_messages, symbols);
+        if (wanted("manager_continuous")) {
+            benchManagerFlow("manager_continuous", MatchingMode::CONTINUOUS, symbols, flow, 100, results);
+        }
+        if (wanted("manager_batch")) {
+            benchManagerFlow("manager_batch", MatchingMode::BATCH, symbols, flow, 100, results);
+        }
+        if (wanted("manager_batch_api")) {
+            benchManagerBatchApi(symbols, flow, 100, results);
+        }
+    }
+
+    std::string json = bench::toJson(results, bench::timerOverheadNs());
+    if (out_path.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(out_path) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "OrderBookManager.hpp"
+#include <cstdint>
+
+//What an agent can see during its step: the books (read-only), its own symbol,
+//simulation time and the fee schedule. Only valid for the duration of the call.
+struct MarketView {
+    const OrderBookManager& books;
+    SymbolId symbol; //The agent's own book
+    uint64_t step;
+    double time;     //Seconds
+    double fee_per_order;
+    double fee_per_share;
+
+    double bestBid() const { return books.getBestBid(symbol); }
+    double bestAsk() const { return books.getBestAsk(symbol); }
+    double mid() const { return (bestBid() + bestAsk()) / 2; } //An empty side counts as 0, like the Python agents
+};
+
+//Where an agent sends orders. The driver stamps the agent's client id, applies
+//its latency and fees; cancels take effect immediately.
+class OrderSink {
+public:
+    virtual ~OrderSink() = default;
+    virtual OrderId nextOrderId() = 0; //Unique within the driver, below the interned-id base
+    virtual void submitOrder(const Order& order) = 0;
+    virtual bool cancelOrder(SymbolId symbol, OrderId order_id) = 0; //False if not resting
+};
+
+//A trading strategy driven once per step
+class Agent {
+public:
+    virtual ~Agent() = default;
+    virtual void onStep(const MarketView& market, OrderSink& orders) = 0;
+};
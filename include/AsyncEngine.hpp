@@ -0,0 +1,106 @@
+#pragma once
+
+#include "OrderBook.hpp"
+#include "RingBuffer.hpp"
+#include "TradeSink.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//Compact ingress message: a new order, or a cancel naming order.symbol/order_id
+struct OrderMessage {
+    enum class Kind : uint8_t { SUBMIT, CANCEL };
+    Kind kind;
+    Order order;
+};
+
+//Egress event published by a matching thread
+enum class EventType : uint8_t { TRADE, ORDER_ACK, CANCEL_ACK };
+
+struct EngineEvent {
+    EventType type;
+    SymbolId symbol;
+    OrderId order_id;    //Acks: the order the message named
+    SubmitResult result; //ORDER_ACK: submit outcome. CANCEL_ACK: CANCELLED with the
+                         //quantity removed, or REJECTED if the order was not resting
+    Trade trade;         //TRADE only
+};
+
+//Asynchronous front end over a set of books. Symbols are split across shards
+//(symbol % shards); each shard owns a bounded MPSC ingress ring, a matching
+//thread that drains it in batches, and an SPSC egress ring of trades and acks.
+//
+//Threading: any number of threads may post; one thread polls. While running,
+//the books belong to the matching threads and must not be touched directly.
+class AsyncEngine {
+public:
+    //books is indexed by SymbolId (null slots allowed) and must outlive the engine
+    AsyncEngine(const std::vector<OrderBook*>& books,
+                size_t shards,
+                size_t queue_capacity = 1 << 16,
+                bool pin_threads = false);
+    ~AsyncEngine(); //Stops if still running
+
+    AsyncEngine(const AsyncEngine&) = delete;
+    AsyncEngine& operator=(const AsyncEngine&) = delete;
+
+    //Producers: false if the shard's ingress ring is full or the engine is stopped
+    bool postOrder(const Order& order);
+    bool postCancel(SymbolId symbol, OrderId order_id);
+
+    //Consumer: appends up to max_events events to out, returns how many.
+    //Events from one shard arrive in order; shards are interleaved.
+    size_t pollEvents(std::vector<EngineEvent>& out, size_t max_events = SIZE_MAX);
+
+    //Processes everything already posted, joins the matching threads and hands
+    //the books back with their previous trade sinks. Unpolled events are kept.
+    void stop();
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+    size_t shardCount() const { return shards_.size(); }
+
+private:
+    static constexpr size_t DRAIN_BATCH = 256; //Messages taken from a ring per pass
+
+    struct Shard;
+
+    //Routes a shard's book output straight into its egress ring
+    class ShardSink : public TradeSink {
+    public:
+        ShardSink(AsyncEngine& engine, Shard& shard) : engine_(engine), shard_(shard) {}
+        void onTrade(const Trade& trade) override;
+    private:
+        AsyncEngine& engine_;
+        Shard& shard_;
+    };
+
+    struct Shard {
+        Shard(AsyncEngine& engine, size_t queue_capacity)
+            : ingress(queue_capacity), egress(queue_capacity), sink(engine, *this) {}
+
+        MpscRing<OrderMessage> ingress;
+        SpscRing<EngineEvent> egress;
+        ShardSink sink;
+        std::vector<OrderBook*> books;   //Books owned by this shard
+        std::vector<OrderBook*> touched; //Batch-mode books that took orders this pass
+        std::atomic<bool> finished{false};
+        std::thread thread;
+    };
+
+    std::vector<OrderBook*> books_;
+    std::vector<TradeSink*> previous_sinks_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<uint8_t> dirty_; //Per symbol: already in its shard's touched list
+    std::vector<EngineEvent> leftover_; //Events collected while stopping
+    std::atomic<bool> running_;
+    std::atomic<bool> stopping_;   //Producers are turned away
+    std::atomic<bool> closed_;     //No producer is still pushing; matchers drain and exit
+    std::atomic<size_t> posting_;  //Producers inside post()
+
+    Shard& shardFor(SymbolId symbol) { return *shards_[symbol % shards_.size()]; }
+    bool post(const OrderMessage& message);
+    void run(Shard& shard, size_t cpu, bool pin_thread);
+    void process(Shard& shard, const OrderMessage& message);
+    void publish(Shard& shard, const EngineEvent& event);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//Little helpers for the flat binary images written by OrderBookManager::saveSnapshot.
+//Values are copied in native layout; readers check bounds and throw on a short image.
+
+class ImageWriter {
+public:
+    explicit ImageWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values go into an image");
+        putBytes(&value, sizeof(T));
+    }
+
+    void putString(const std::string& text) {
+        put(static_cast<uint32_t>(text.size()));
+        putBytes(text.data(), text.size());
+    }
+
+    void putBytes(const void* data, size_t size) {
+        size_t offset = out_.size();
+        out_.resize(offset + size);
+        if (size > 0) std::memcpy(out_.data() + offset, data, size);
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+class ImageReader {
+public:
+    ImageReader(const uint8_t* data, size_t size) : cursor_(data), end_(data + size) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values come out of an image");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t size = get<uint32_t>();
+        const uint8_t* text = take(size);
+        return std::string(reinterpret_cast<const char*>(text), size);
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end_ - cursor_); }
+
+private:
+    const uint8_t* cursor_;
+    const uint8_t* end_;
+
+    const uint8_t* take(size_t size) {
+        if (size > remaining()) {
+            throw std::runtime_error("Snapshot image is truncated");
+        }
+        const uint8_t* start = cursor_;
+        cursor_ += size;
+        return start;
+    }
+};
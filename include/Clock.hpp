@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+//Nanosecond timestamp source for accepted orders and trades.
+//Books read it once per accepted order and once per matching pass.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual uint64_t now() = 0;
+    virtual void onBatchStart() {} //Called by OrderBookManager::processOrders
+    virtual std::unique_ptr<Clock> clone() const = 0; //Same time source and state, for OrderBookManager::fork
+};
+
+//Time driven by the simulation loop, so runs are deterministic and replayable.
+//Atomic so async matching threads can read it while the loop advances it.
+class SimulatedClock : public Clock {
+public:
+    explicit SimulatedClock(uint64_t start_ns = 0) : time_ns_(start_ns) {}
+
+    uint64_t now() override { return time_ns_.load(std::memory_order_relaxed); }
+    std::unique_ptr<Clock> clone() const override {
+        return std::make_unique<SimulatedClock>(time_ns_.load(std::memory_order_relaxed));
+    }
+
+    void setTime(uint64_t time_ns) { time_ns_.store(time_ns, std::memory_order_relaxed); }
+    void setSeconds(double seconds) { setTime(static_cast<uint64_t>(seconds * 1e9 + 0.5)); }
+    void advance(uint64_t delta_ns) { time_ns_.fetch_add(delta_ns, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> time_ns_;
+};
+
+//Monotonic wall time from std::chrono::steady_clock
+class SteadyClock : public Clock {
+public:
+    uint64_t now() override {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    std::unique_ptr<Clock> clone() const override { return std::make_unique<SteadyClock>(); }
+};
+
+//Reads the wrapped clock once per processOrders() call and stamps everything
+//in between with that value: one clock read per batch instead of per object
+class BatchClock : public Clock {
+public:
+    explicit BatchClock(std::unique_ptr<Clock> source = std::make_unique<SteadyClock>())
+        : source_(std::move(source)), stamp_ns_(source_->now()) {}
+
+    uint64_t now() override { return stamp_ns_; }
+    void onBatchStart() override { stamp_ns_ = source_->now(); }
+    std::unique_ptr<Clock> clone() const override {
+        auto copy = std::make_unique<BatchClock>(source_->clone());
+        copy->stamp_ns_ = stamp_ns_;
+        return copy;
+    }
+
+private:
+    std::unique_ptr<Clock> source_;
+    uint64_t stamp_ns_;
+};
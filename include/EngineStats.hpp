@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//Optional hot-path instrumentation for OrderBook and OrderBookManager.
+//Built only with ORDERBOOK_STATS=1 (CMake option ORDERBOOK_STATS); otherwise the
+//recording macros below expand to nothing and readEngineStats() reports enabled = false.
+//
+//Each thread records into its own block with plain relaxed stores, so recording
+//never locks or contends; readEngineStats() sums every block. Blocks are kept when
+//their thread exits and handed to the next new thread, so counts are never lost.
+
+enum class StatsOp : uint8_t {
+    ADD,      //Limit order submission
+    CANCEL,
+    MATCH,    //OrderBook::matchOrders pass
+    MARKET,   //Market and market-to-limit submission
+    SNAPSHOT, //OrderBookManager::snapshot
+    COUNT
+};
+
+enum class StatsCounter : uint8_t {
+    ORDERS, //Accepted submissions
+    TRADES,
+    LEVELS_CREATED,
+    LEVELS_DESTROYED,
+    REJECTS,
+    COUNT
+};
+
+const char* statsOpName(StatsOp op);
+const char* statsCounterName(StatsCounter counter);
+
+//Log-linear buckets in the style of HdrHistogram: 16 sub-buckets per power of two,
+//so any recorded value is reported within about 6% of its true size
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKETS = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    static int bucketFor(uint64_t value) {
+        if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+            return static_cast<int>(value);
+        }
+#ifdef _MSC_VER
+        unsigned long top;
+        _BitScanReverse64(&top, value);
+        int exponent = static_cast<int>(top);
+#else
+        int exponent = 63 - __builtin_clzll(value);
+#endif
+        int shift = exponent - SUB_BUCKET_BITS;
+        int sub = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+    }
+    static uint64_t bucketValue(int bucket); //Midpoint of the bucket's range
+
+    void add(int bucket, uint64_t count) { counts_[bucket] += count; }
+    void addTotals(uint64_t count, uint64_t sum, uint64_t max);
+
+    uint64_t count() const { return count_; }
+    double mean() const { return count_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_); }
+    uint64_t max() const { return max_; }
+    uint64_t percentile(double p) const; //p in [0, 1]; 0 when empty
+
+private:
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+};
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+struct EngineStats {
+    bool enabled = false;
+    std::array<LatencySummary, static_cast<size_t>(StatsOp::COUNT)> latency;
+    std::array<uint64_t, static_cast<size_t>(StatsCounter::COUNT)> counters{};
+    uint64_t peak_depth = 0; //Most orders resting in one book at once
+
+    const LatencySummary& operator[](StatsOp op) const { return latency[static_cast<size_t>(op)]; }
+    uint64_t operator[](StatsCounter counter) const { return counters[static_cast<size_t>(counter)]; }
+};
+
+EngineStats readEngineStats();     //Merged over every thread that has recorded
+LatencyHistogram readHistogram(StatsOp op);
+void resetEngineStats();           //Approximate if other threads are recording meanwhile
+
+//One thread's recordings. Only the owning thread writes; readers load with relaxed order.
+struct ThreadStats {
+    struct Op {
+        std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+    std::array<Op, static_cast<size_t>(StatsOp::COUNT)> ops;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(StatsCounter::COUNT)> counters{};
+    std::atomic<uint64_t> peak_depth{0};
+
+    static void bump(std::atomic<uint64_t>& value, uint64_t by) {
+        value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+    static void raise(std::atomic<uint64_t>& value, uint64_t to) {
+        if (to > value.load(std::memory_order_relaxed)) value.store(to, std::memory_order_relaxed);
+    }
+
+    void record(StatsOp which, uint64_t ns) {
+        Op& op = ops[static_cast<size_t>(which)];
+        bump(op.buckets[LatencyHistogram::bucketFor(ns)], 1);
+        bump(op.count, 1);
+        bump(op.sum, ns);
+        raise(op.max, ns);
+    }
+    void count(StatsCounter counter, uint64_t by) { bump(counters[static_cast<size_t>(counter)], by); }
+    void peak(uint64_t depth) { raise(peak_depth, depth); }
+};
+
+ThreadStats* acquireThreadStats(); //Registers a block for the calling thread
+void releaseThreadStats(ThreadStats* block);
+
+inline ThreadStats& threadStats() {
+    struct Slot {
+        ThreadStats* block = acquireThreadStats();
+        ~Slot() { releaseThreadStats(block); }
+    };
+    static thread_local Slot slot;
+    return *slot.block;
+}
+
+//Times its scope into the calling thread's histogram for `op`
+class StatsTimer {
+public:
+    explicit StatsTimer(StatsOp op) : op_(op), start_(std::chrono::steady_clock::now()) {}
+    ~StatsTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        threadStats().record(op_, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    StatsTimer(const StatsTimer&) = delete;
+    StatsTimer& operator=(const StatsTimer&) = delete;
+
+private:
+    StatsOp op_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#if ORDERBOOK_STATS
+#define ORDERBOOK_STATS_TIMER(op) StatsTimer orderbook_stats_timer_(op)
+#define ORDERBOOK_STATS_COUNT(counter, by) threadStats().count(counter, by)
+#define ORDERBOOK_STATS_PEAK(depth) threadStats().peak(depth)
+#else
+#define ORDERBOOK_STATS_TIMER(op) ((void)0)
+#define ORDERBOOK_STATS_COUNT(counter, by) ((void)0)
+#define ORDERBOOK_STATS_PEAK(depth) ((void)0)
+#endif
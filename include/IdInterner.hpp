@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+
+//Two-way string <-> integer id table used only at the API edge
+//(OrderBookManager string overloads and the Python bindings).
+//Ids are dense and start at base (default 1, so 0 can mean "no id").
+template <typename Id>
+class IdInterner {
+public:
+    explicit IdInterner(Id base = 1) : base_(base) {}
+
+    //Returns the existing id for name, or assigns the next one
+    Id intern(const std::string& name) {
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        Id id = static_cast<Id>(base_ + names_.size());
+        ids_.emplace(name, id);
+        names_.push_back(name);
+        return id;
+    }
+
+    bool find(const std::string& name, Id& id) const {
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            return false;
+        }
+        id = it->second;
+        return true;
+    }
+
+    bool contains(Id id) const {
+        return id >= base_ && static_cast<size_t>(id - base_) < names_.size();
+    }
+
+    const std::string& name(Id id) const {
+        if (!contains(id)) {
+            throw std::out_of_range("Unknown interned id");
+        }
+        return names_[static_cast<size_t>(id - base_)];
+    }
+
+    size_t size() const { return names_.size(); }
+    Id base() const { return base_; }
+
+private:
+    Id base_;
+    std::unordered_map<std::string, Id> ids_;
+    std::vector<std::string> names_; //names_[id - base_]
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Order.hpp"
+#include "Trade.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------ On-disk format ----------------
+//A JournalHeader followed by fixed-size JournalRecords, appended in sequence order.
+//Little-endian, native layout; readers check magic, version and record size.
+
+enum class JournalEvent : uint8_t {
+    BOOK,        //symbol added: price = tick size
+    REMOVE_BOOK, //symbol removed
+    MODE,        //matching mode set: quantity = MatchingMode
+    ADD,         //order accepted: order_id, other_id = client id, price, quantity, side, type, tif
+    CANCEL,      //resting order cancelled: order_id
+    BATCH,       //matching pass over all books (processOrders and friends)
+    TRADE        //trade from a matching pass: order_id = buy, other_id = sell, price, quantity
+};
+
+struct JournalRecord {
+    uint64_t sequence;  //0, 1, 2... per journal
+    uint64_t timestamp; //Engine clock (ns) when the event happened
+    uint64_t order_id;
+    uint64_t other_id;
+    double price;
+    SymbolId symbol;
+    int32_t quantity;
+    JournalEvent event;
+    Side side;
+    OrderType type;
+    TimeInForce tif;
+    uint32_t reserved;
+};
+static_assert(sizeof(JournalRecord) == 56, "Journal records are fixed-size on disk");
+
+struct JournalHeader {
+    char magic[8];        //"OBJRNL\0\0"
+    uint32_t version;
+    uint32_t record_size; //sizeof(JournalRecord)
+    uint64_t reserved[2];
+};
+static_assert(sizeof(JournalHeader) == 32, "Journal header is fixed-size on disk");
+
+constexpr uint32_t JOURNAL_VERSION = 1;
+
+//------------ Writing ----------------
+
+//Append-only journal file. append() only copies into the active batch; full
+//batches are written by a background thread while the next one fills, so the
+//caller waits on disk only if it gets a whole batch ahead of the writer.
+//Single producer: call from one thread at a time.
+class JournalWriter {
+public:
+    explicit JournalWriter(const std::string& path, size_t batch_records = 1 << 16);
+    ~JournalWriter(); //Writes whatever is still buffered
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    void append(JournalRecord record) {
+        record.sequence = next_sequence_++;
+        active_.push_back(record);
+        if (active_.size() >= batch_records_) {
+            handOff();
+        }
+    }
+
+    //Convenience builders for the engine's events
+    void appendOrder(const Order& order, uint64_t timestamp);
+    void appendTrade(const Trade& trade);
+    void appendEvent(JournalEvent event, SymbolId symbol, uint64_t timestamp,
+                     OrderId order_id = 0, double price = 0.0, int32_t quantity = 0);
+
+    void flush(); //Returns once everything appended so far is written to the file
+    uint64_t recordCount() const { return next_sequence_; }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    std::FILE* file_;
+    size_t batch_records_;
+    uint64_t next_sequence_;
+
+    std::vector<JournalRecord> active_;  //Filled by append()
+    std::vector<JournalRecord> pending_; //Owned by the writer thread while non-empty
+
+    std::mutex mutex_;
+    std::condition_variable batch_ready_;
+    std::condition_variable batch_written_;
+    bool stopping_;
+    std::exception_ptr error_; //First write failure, rethrown on the next hand-off
+    std::thread writer_;
+
+    void handOff();
+    void writerLoop();
+};
+
+//------------ Reading and replay ----------------
+
+//Read-only view of a journal file, memory-mapped where the platform allows
+class JournalReader {
+public:
+    explicit JournalReader(const std::string& path);
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    const JournalRecord* begin() const { return records_; }
+    const JournalRecord* end() const { return records_ + count_; }
+    size_t size() const { return count_; }
+    const JournalRecord& operator[](size_t i) const { return records_[i]; }
+
+private:
+    const JournalRecord* records_;
+    size_t count_;
+    void* mapping_;     //Whole file
+    size_t mapped_size_;
+    std::vector<JournalRecord> fallback_; //Used where mmap is unavailable
+
+    void unmap();
+};
+
+class OrderBookManager;
+
+struct ReplayStats {
+    uint64_t records = 0;
+    uint64_t orders = 0;
+    uint64_t cancels = 0;
+    uint64_t batches = 0;
+    uint64_t journal_trades = 0;    //TRADE records read
+    uint64_t replay_trades = 0;     //Trades the target produced
+    uint64_t mismatched_trades = 0; //Journalled trades the replay did not reproduce; 0 when faithful
+    double seconds = 0.0;
+};
+
+//Drives `target` with the journal's events as fast as it can. The target must be
+//fresh: books are re-added in journal order, named by their id, and must get the
+//same ids. The target's clock is replaced by a SimulatedClock that follows the journal.
+ReplayStats replayJournal(const JournalReader& journal, OrderBookManager& target);
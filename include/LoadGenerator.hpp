@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Journal.hpp"
+#include "Order.hpp"
+#include "OrderBook.hpp"
+#include <cstdint>
+#include <vector>
+
+class OrderBookManager;
+
+//------------ Synthetic order flow for load tests ----------------
+//Generates order and cancel messages over many symbols, fast enough that the
+//engine rather than the generator is what a capacity test measures.
+
+enum class ArrivalProcess : uint8_t {
+    POISSON, //Independent exponential gaps
+    HAWKES   //Self-exciting bursts with an exponential kernel
+};
+
+struct LoadConfig {
+    size_t symbols = 100;
+    double tick_size = 0.01;
+    double start_price = 100.0;
+    MatchingMode mode = MatchingMode::CONTINUOUS;
+
+    //Arrivals over all symbols, in simulated time. `rate` is the long-run mean for
+    //both processes; a Hawkes stream gets baseline rate * (1 - hawkes_branching).
+    ArrivalProcess arrivals = ArrivalProcess::POISSON;
+    double rate = 1e6;               //Messages per second
+    double hawkes_branching = 0.8;   //Mean messages each message triggers, in [0, 1)
+    double hawkes_decay = 1e4;       //Per second: how fast a burst dies out
+
+    //Message mix; weights need not sum to 1
+    double limit_weight = 0.6;
+    double market_weight = 0.1;
+    double cancel_weight = 0.3;
+
+    //Limit prices relative to the same-side touch: most rest a geometric number
+    //of ticks behind it (mean passive_mean_ticks), marketable_prob cross the spread
+    double passive_mean_ticks = 2.0;
+    double marketable_prob = 0.05;
+    double ioc_prob = 0.0;           //Share of limit orders sent IOC instead of GTC
+
+    int min_quantity = 1;
+    int max_quantity = 100;
+    uint32_t clients = 64;           //Client ids 1..clients, picked uniformly
+
+    //Without a book to read (journal output) the touch is a random walk:
+    //each message moves its symbol's mid one tick with this probability
+    double walk_prob = 0.01;
+    int spread_ticks = 2;
+};
+
+enum class LoadAction : uint8_t { ORDER, CANCEL };
+
+struct LoadMessage {
+    uint64_t time_ns; //Simulated arrival time
+    LoadAction action;
+    Order order;      //CANCEL: only symbol and order_id are meaningful
+};
+
+struct LoadStats {
+    uint64_t messages = 0;
+    uint64_t orders = 0;
+    uint64_t cancels = 0;
+    uint64_t cancels_missed = 0;   //Cancel targets that had already traded or been cancelled
+    uint64_t rejects = 0;
+    uint64_t trades = 0;
+    uint64_t batches = 0;          //Matching passes (BATCH mode)
+    double generate_seconds = 0.0; //Wall time spent generating
+    double engine_seconds = 0.0;   //Wall time spent in the manager or journal writer
+};
+
+//Deterministic for a given config and seed. Symbol i (0-based) is book id i + 1,
+//which is what a fresh OrderBookManager hands out; addBooks() rebinds the ids
+//if the manager already had books.
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const LoadConfig& config, uint64_t seed = 0);
+
+    const LoadConfig& config() const { return config_; }
+    SymbolId symbolId(size_t index) const { return symbols_[index].id; }
+    uint64_t now() const { return time_ns_; } //Arrival time of the last message
+
+    void generate(LoadMessage* out, size_t count);
+
+    //Adds one book per symbol (named LOAD0, LOAD1, ...) in the configured mode
+    void addBooks(OrderBookManager& manager);
+
+    //Reads each book's touch so following prices track the live market; symbols
+    //with an empty side keep their previous touch
+    void observe(const OrderBookManager& manager);
+
+    //Feeds `messages` messages to a manager set up by addBooks(), `batch` at a
+    //time. Installs a SimulatedClock that follows the arrival times; in BATCH mode
+    //the books are matched after every batch. Trades are drained and counted.
+    LoadStats drive(OrderBookManager& manager, uint64_t messages, size_t batch = 4096);
+
+    //Writes a journal that replayJournal() can feed to a fresh manager: BOOK and
+    //MODE records, then the messages with a BATCH record after every `batch`.
+    //There is no engine in the loop, so the journal has no TRADE records.
+    LoadStats writeJournal(JournalWriter& journal, uint64_t messages, size_t batch = 4096);
+
+private:
+    struct SymbolState {
+        SymbolId id;
+        Price bid; //Touch in ticks
+        Price ask;
+        std::vector<OrderId> live; //Resting candidates for cancels
+    };
+
+    static constexpr size_t MAX_LIVE = 256; //Per symbol; beyond it a random old id is forgotten
+
+    LoadConfig config_;
+    uint64_t rng_state_;
+    std::vector<SymbolState> symbols_;
+    OrderId next_order_id_;
+    uint64_t time_ns_;
+    double time_s_;
+    double hawkes_excess_; //Hawkes intensity above the baseline, per second
+    double limit_cut_;     //Cumulative mix thresholds on a uniform draw
+    double market_cut_;
+    std::vector<uint64_t> offset_cdf_; //P(passive offset <= k) scaled to 2^64, for k = 0, 1, ...
+
+    //splitmix64, the generator behind deriveSeed: several times cheaper per draw
+    //than std::mt19937_64, which matters at tens of millions of messages a second
+    uint64_t draw() {
+        uint64_t z = (rng_state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return static_cast<double>(draw() >> 11) * 0x1.0p-53; } //[0, 1)
+    uint32_t below(uint32_t bound) { //Uniform in [0, bound), by multiply-shift
+        return static_cast<uint32_t>(((draw() >> 32) * bound) >> 32);
+    }
+
+    double nextGap();
+    void nextMessage(LoadMessage& message);
+    void makeOrder(SymbolState& symbol, LoadMessage& message);
+    void rememberOrder(SymbolState& symbol, OrderId order_id);
+};
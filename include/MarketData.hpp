@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Order.hpp"
+#include "Trade.hpp"
+#include "RingBuffer.hpp"
+#include <atomic>
+#include <functional>
+
+//Incremental market data pushed by books as they change (see OrderBook::setMarketDataSink).
+//A subscriber that applies every update in sequence order holds the same levels and
+//top of book as the engine, without querying depth.
+
+enum class MarketDataEvent : uint8_t {
+    CLEAR,        //Forget every level of this symbol; levels that exist follow as LEVEL_ADD
+    LEVEL_ADD,    //New price level
+    LEVEL_UPDATE, //Quantity or order count of an existing level changed
+    LEVEL_DELETE, //Level emptied
+    TOP_OF_BOOK,  //Best bid/ask price or size changed; sent once per operation, after its level updates
+    TRADE         //Execution, before the level updates it causes
+};
+
+struct MarketDataUpdate {
+    uint64_t sequence;  //Per book, from 1 with no gaps; restarts when a book is replaced
+    uint64_t timestamp; //Engine clock (ns) of the operation that caused it
+    SymbolId symbol;
+    MarketDataEvent event;
+    Side side;          //LEVEL_*: side of the level. TRADE: incoming side (BUY for batch crossings)
+    int32_t orders;     //LEVEL_*: orders at the level after the change
+    double price;       //LEVEL_*: level price. TRADE: execution price. TOP_OF_BOOK: best bid (0 if none)
+    int64_t quantity;   //LEVEL_*: level total after the change. TRADE: traded. TOP_OF_BOOK: best bid size
+    double ask_price;   //TOP_OF_BOOK: best ask (0 if none)
+    int64_t ask_quantity; //TOP_OF_BOOK: best ask size
+    TradeId trade_id;   //TRADE
+};
+
+//Receives a book's updates as they happen. Books hold a non-owning pointer. With
+//parallel matching or async mode, updates for different books arrive from several
+//threads at once (each book's own updates are never concurrent).
+class MarketDataSink {
+public:
+    virtual ~MarketDataSink() = default;
+    virtual void onUpdate(const MarketDataUpdate& update) = 0;
+};
+
+//Calls a function for every update
+class MarketDataCallback : public MarketDataSink {
+public:
+    explicit MarketDataCallback(std::function<void(const MarketDataUpdate&)> callback)
+        : callback_(std::move(callback)) {}
+    void onUpdate(const MarketDataUpdate& update) override { callback_(update); }
+
+private:
+    std::function<void(const MarketDataUpdate&)> callback_;
+};
+
+//Bounded queue drained by one consumer. The engine never waits on it: an update
+//that finds the ring full is dropped and counted, and the consumer sees a gap in
+//that symbol's sequence (resubscribe to get a CLEAR and a fresh copy of the book).
+class MarketDataRing : public MarketDataSink {
+public:
+    explicit MarketDataRing(size_t capacity = 1 << 16) : ring_(capacity) {}
+
+    void onUpdate(const MarketDataUpdate& update) override {
+        if (!ring_.tryPush(update)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //Pops up to max updates in arrival order, returns how many
+    size_t drain(MarketDataUpdate* out, size_t max) { return ring_.popBatch(out, max); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return ring_.capacity(); }
+
+private:
+    MpscRing<MarketDataUpdate> ring_;
+    std::atomic<uint64_t> dropped_{0};
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "NativeAgents.hpp"
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <vector>
+
+struct Scenario {
+    SimulationConfig config; //seed and record_interval are set per run
+    AgentMix agents;
+};
+
+//One row per run, in run order (scenario-major: run = scenario * seeds + seed index)
+struct MonteCarloResults {
+    std::vector<uint32_t> scenario;
+    std::vector<uint64_t> seed;
+    std::vector<uint64_t> trades;
+    std::vector<uint64_t> orders_submitted;
+    std::vector<uint64_t> orders_rejected;
+    //Final PnL summed over each kind of agent
+    std::vector<double> market_maker_pnl;
+    std::vector<double> trend_follower_pnl;
+    std::vector<double> mean_reverter_pnl;
+    std::vector<double> liquidity_taker_pnl;
+    std::vector<int64_t> gross_inventory;     //Sum of |inventory| over all agents
+    std::vector<double> fundamental_drift;    //Mean final fundamental minus initial mid
+
+    size_t size() const { return seed.size(); }
+    void resize(size_t runs);
+};
+
+//Runs every scenario once per seed, each as an isolated Simulation (own books,
+//RNG and agents, no history kept). Runs are claimed dynamically by the pool's
+//workers, so long and short scenarios balance out; each row depends only on
+//its scenario and seed, never on which worker ran it or when.
+MonteCarloResults runMonteCarlo(const std::vector<Scenario>& scenarios,
+                                const std::vector<uint64_t>& seeds,
+                                ThreadPool& pool);
+
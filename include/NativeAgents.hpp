@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Agent.hpp"
+#include "Simulation.hpp"
+#include <deque>
+#include <random>
+
+//C++ ports of the rule-based agents in python/orderbook_agents, with the same
+//parameters and defaults. All are fee-aware through MarketView.
+
+//Cancels its last quotes every step and requotes mid +/- spread/2 when the
+//half spread covers the fees
+class MarketMakerAgent : public Agent {
+public:
+    explicit MarketMakerAgent(double spread = 1.0, int size = 1);
+    void onStep(const MarketView& market, OrderSink& orders) override;
+
+private:
+    double spread_;
+    int size_;
+    OrderId bid_id_; //0 when not quoting
+    OrderId ask_id_;
+};
+
+//Market order in the direction of the return over `lookback` steps when it
+//beats the threshold and the fees
+class TrendFollowerAgent : public Agent {
+public:
+    explicit TrendFollowerAgent(int lookback = 3, double threshold = 0.002, int size = 1);
+    void onStep(const MarketView& market, OrderSink& orders) override;
+
+private:
+    int lookback_;
+    double threshold_;
+    int size_;
+    std::deque<double> mids_; //Last lookback + 1 mids
+};
+
+//Market order back towards the average of the previous `lookback` mids when
+//the deviation beats threshold * average plus the fees
+class MeanReverterAgent : public Agent {
+public:
+    explicit MeanReverterAgent(int lookback = 10, double threshold = 0.005, int size = 1);
+    void onStep(const MarketView& market, OrderSink& orders) override;
+
+private:
+    int lookback_;
+    double threshold_;
+    int size_;
+    std::deque<double> mids_; //Last lookback + 1 mids
+};
+
+//With probability order_prob, a random-side market order of size in
+//[min_size, max_size] if the half spread covers the fees
+class LiquidityTakerAgent : public Agent {
+public:
+    explicit LiquidityTakerAgent(double order_prob = 0.1, int min_size = 1, int max_size = 5, uint64_t seed = 0);
+    void onStep(const MarketView& market, OrderSink& orders) override;
+
+private:
+    double order_prob_;
+    int min_size_;
+    int max_size_;
+    std::mt19937_64 rng_;
+};
+
+//A population of the native agents, assigned to symbols round robin in
+//the order listed (as simulation.py does); defaults match the Python agents
+struct AgentMix {
+    size_t market_makers = 2;
+    double market_maker_spread = 1.0;
+    int market_maker_size = 1;
+    size_t trend_followers = 2;
+    size_t mean_reverters = 2;
+    size_t liquidity_takers = 2;
+    double liquidity_taker_prob = 0.1;
+};
+
+enum class AgentKind : uint8_t { MARKET_MAKER, TREND_FOLLOWER, MEAN_REVERTER, LIQUIDITY_TAKER };
+
+//Adds the mix to the simulation (named MM-0, TF-0, ...) and returns each added agent's kind.
+//Random agents are seeded from deriveSeed(seed, agent id).
+std::vector<AgentKind> addAgentMix(Simulation& simulation, const AgentMix& mix, uint64_t seed);
+
+//Independent seed for stream `stream` of a run seeded with `seed` (splitmix64)
+uint64_t deriveSeed(uint64_t seed, uint64_t stream);
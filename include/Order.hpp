@@ -1,56 +1,101 @@
 #pragma once
 
-#include <string>
-#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <stdexcept>
 
-enum class Side { BUY, SELL };
-enum class OrderType { LIMIT, MARKET };
+enum class Side : uint8_t { BUY, SELL };
+enum class OrderType : uint8_t { LIMIT, MARKET, MARKET_TO_LIMIT };
 
+//How long an order may stay in the book:
+//GTC rests until cancelled, IOC cancels whatever does not trade on arrival,
+//FOK trades its full quantity on arrival or not at all
+enum class TimeInForce : uint8_t { GTC, IOC, FOK };
+
+using Price = int64_t; //Book prices are integer ticks (see OrderBook::getTickSize)
+
+//Engine-side ids. Strings only exist at the OrderBookManager/Python edge (see IdInterner)
+using OrderId = uint64_t;
+using ClientId = uint32_t;
+using SymbolId = uint32_t;
+
+//Plain data, 40 bytes: trivially copyable so books and queues can move it with memcpy
 struct Order {
-    std::string order_id;
-    std::string client_id;
-    std::string symbol;
-    Side side;
+    OrderId order_id;
+    ClientId client_id;
+    SymbolId symbol;
     double price;
     int quantity;
+    Side side;
     OrderType type;
+    TimeInForce tif;
     uint64_t timestamp;
 
     //Constructor
-    Order(const std::string& order_id,
-          const std::string& client_id,
-          const std::string& symbol,
+    Order(OrderId order_id,
+          ClientId client_id,
+          SymbolId symbol,
           Side side,
           double price,
           int quantity,
-          OrderType type = OrderType::LIMIT)
+          OrderType type = OrderType::LIMIT,
+          TimeInForce tif = TimeInForce::GTC)
         : order_id(order_id),
           client_id(client_id),
           symbol(symbol),
-          side(side),
           price(price),
           quantity(quantity),
+          side(side),
           type(type),
-          timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
-              std::chrono::system_clock::now().time_since_epoch()).count()) {
+          tif(tif),
+          timestamp(0) { //Stamped by the book's clock when accepted
+        if (const char* error = validate(type, price, quantity)) {
+            throw std::runtime_error(error);
+        }
+    }
+
+    //Default constructor
+    Order() = default;
+
+    //Null if the fields describe a valid order, otherwise the reason the constructor throws.
+    //Batch paths build orders field by field and check with this instead.
+    static const char* validate(OrderType type, double price, int quantity) {
+        if (type == OrderType::LIMIT && !std::isfinite(price)) {
+            return "Limit order price must be finite"; //NaN would slip past the check below
+        }
         if (type == OrderType::LIMIT && price <= 0) {
-            throw std::runtime_error("Limit order price must be positive");
+            return "Limit order price must be positive";
         }
-        if (type == OrderType::MARKET && price != 0) {
-            throw std::runtime_error("Market order price must be 0");
+        if (type != OrderType::LIMIT && price != 0) {
+            return "Market order price must be 0";
         }
         if (quantity <= 0) {
-            throw std::runtime_error("Order quantity must be positive");
+            return "Order quantity must be positive";
         }
+        return nullptr;
     }
 
-    //Default constructor
-    Order() = default;
-
     //Helper methods
     bool isBuy() const { return side == Side::BUY; }
     bool isSell() const { return side == Side::SELL; }
     bool isLimit() const { return type == OrderType::LIMIT; }
     bool isMarket() const { return type == OrderType::MARKET; }
+    bool isMarketToLimit() const { return type == OrderType::MARKET_TO_LIMIT; }
+};
+
+//Outcome of OrderBook::submitOrder. Only RESTING and PARTIALLY_FILLED leave
+//quantity in the book; every other status is final for the order.
+enum class SubmitStatus : uint8_t {
+    RESTING,             //Accepted without trading, whole quantity rests
+    PARTIALLY_FILLED,    //Traded some, remainder rests
+    FILLED,              //Traded in full
+    PARTIALLY_CANCELLED, //Traded some, remainder cancelled (IOC/market, or no room to rest)
+    CANCELLED,           //Nothing traded, nothing rests (no liquidity or FOK kill)
+    REJECTED             //Not accepted: unknown book or price outside the ladder
+};
+
+struct SubmitResult {
+    SubmitStatus status;
+    int filled;    //Quantity traded on arrival
+    int remaining; //Quantity that did not trade (resting or cancelled, see status)
 }; 
\ No newline at end of file
@@ -2,53 +2,191 @@
 
 #include "Order.hpp"
 #include "Trade.hpp"
-#include <map>
-#include <list>
-#include <unordered_map>
+#include "PriceLadder.hpp"
+#include "OrderPool.hpp"
+#include "OrderIndex.hpp"
+#include "Clock.hpp"
+#include "TradeSink.hpp"
+#include "MarketData.hpp"
+#include "BinaryImage.hpp"
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_set>
+
+//BATCH: limit orders rest until matchOrders() crosses the book, executing at the ask.
+//CONTINUOUS: limit orders match on arrival at the resting price, the remainder rests,
+//so the book is never crossed and matchOrders() only drains buffered trades.
+enum class MatchingMode : uint8_t { BATCH, CONTINUOUS };
 
 class OrderBook {
 public:
-    explicit OrderBook(const std::string& symbol);
+    OrderBook(SymbolId symbol, const std::string& name, double tick_size = 0.01);
+    //Deep copy (same levels, queues, ids and trade sequence)
+    OrderBook(const OrderBook& other);
+    OrderBook& operator=(const OrderBook&) = delete;
+
+    //Copy-on-write forks. A book shared between managers is never changed in place; a
+    //manager that needs to change it branches it instead. The branch copies the level
+    //headers (O(levels)) and reads every queue and order node through `base`; a level's
+    //queue is copied the first time the branch changes that level, and order lookups
+    //fall through to `base` for orders the branch has not touched. Branches of branches
+    //deeper than MAX_BRANCH_DEPTH are flattened with a full copy instead.
+    static constexpr size_t MAX_BRANCH_DEPTH = 8;
+    static std::shared_ptr<OrderBook> branch(std::shared_ptr<const OrderBook> base);
+    //Call while holding the only reference to this book: once nothing else shares its
+    //base either, takes the base's storage over in O(orders changed since branching)
+    void reclaimBase() {
+        if (base_) absorbBases();
+    }
+    size_t branchDepth() const { return branch_depth_; } //0 for a book that shares nothing
 
     //Main Orderbook ops
-    void addOrder(const Order& order);
-    void cancelOrder(const std::string& order_id);
-    std::vector<Trade> matchOrders();
+    SubmitResult submitOrder(const Order& order) { return submitOrder(order, currentTime()); } //Never throws for market conditions
+    void addOrder(const Order& order) { addOrder(order, currentTime()); } //Throws if a market order cannot fill in full
+    bool tryCancelOrder(OrderId order_id);        //False if the order is not resting
+    void cancelOrder(OrderId order_id);
+    std::vector<Trade> matchOrders() { return matchOrders(currentTime()); } //Uncrosses (batch mode) and returns buffered trades
+    //Same, stamped with a time the caller already read (e.g. the one it journals) instead of reading the clock
+    SubmitResult submitOrder(const Order& order, uint64_t now);
+    void addOrder(const Order& order, uint64_t now);
+    std::vector<Trade> matchOrders(uint64_t now);
     void clear();
 
+    //Matching behaviour and trade delivery
+    void setMatchingMode(MatchingMode mode); //Switching to CONTINUOUS uncrosses the book first
+    MatchingMode getMatchingMode() const { return mode_; }
+    void setTradeSink(TradeSink* sink) { trade_sink_ = sink; } //Not owned; null buffers for matchOrders()
+    TradeSink* getTradeSink() const { return trade_sink_; }
+    //Not owned; null stops the feed. Installing a sink first sends it CLEAR, every
+    //current level and the top of book, so it starts from the book as it is now.
+    void setMarketDataSink(MarketDataSink* sink);
+    MarketDataSink* getMarketDataSink() const { return market_data_; }
+
     //Market data queries for agents
     double getBestBid() const;
     double getBestAsk() const;
     int getBidSize() const;
     int getAskSize() const;
+    int getBidOrderCount() const;
+    int getAskOrderCount() const;
     std::vector<std::pair<double, int>> getBidDepth(int levels) const;
     std::vector<std::pair<double, int>> getAskDepth(int levels) const;
+    //Allocation-free depth: writes up to levels prices/quantities best first, returns the count
+    int copyBidDepth(int levels, double* prices, int* quantities) const { return copyDepth(bids_, levels, prices, quantities); }
+    int copyAskDepth(int levels, double* prices, int* quantities) const { return copyDepth(asks_, levels, prices, quantities); }
+
+    //Calls visit(const Order&) for every resting order: bids then asks, best level
+    //first and in queue order within a level, so re-adding them rebuilds the book
+    template <typename Visitor>
+    void forEachRestingOrder(Visitor&& visit) const {
+        visitSide(bids_, visit);
+        visitSide(asks_, visit);
+    }
+
+    //Binary image of the resting orders, levels best first and queues in order
+    //(see OrderBookManager::saveSnapshot). loadState needs an empty book and
+    //rebuilds it without matching; it throws on an inconsistent image.
+    void saveState(ImageWriter& image) const;
+    void loadState(ImageReader& image);
 
     //Helper methods
-    bool hasOrder(const std::string& order_id) const;
-    const Order* getOrder(const std::string& order_id) const;
-    const std::string& getSymbol() const { return symbol_; }
+    bool hasOrder(OrderId order_id) const;
+    const Order* getOrder(OrderId order_id) const;
+    SymbolId getSymbol() const { return symbol_; }
+    const std::string& getName() const { return name_; }
+    double getTickSize() const { return tick_size_; }
+    void setClock(Clock* clock) { clock_ = clock; } //Not owned; null stamps 0
+    Clock* getClock() const { return clock_; }
+    bool needsMatching() const; //False if matchOrders() would neither trade nor return trades
+
+    //Allocation counters for the resting-order storage
+    struct AllocationStats {
+        OrderPool::Stats pool;
+        uint64_t index_rehashes = 0;
+    };
+    AllocationStats getAllocationStats() const;
 
 private:
-    std::string symbol_;
+    SymbolId symbol_;
+    std::string name_; //Display name
+    uint64_t trade_sequence_; //Last trade sequence number issued by this book
+    double tick_size_;
+    Clock* clock_;
+    MatchingMode mode_;
     
-    // Price levels for bids and asks --> ordered levels with map
-    std::map<double, std::list<Order>, std::greater<double>> bids_; //Highest First
-    std::map<double, std::list<Order>, std::less<double>> asks_; //Lowest First
+    // Price levels for bids and asks --> dense tick ladders
+    PriceLadder bids_; //Best = highest
+    PriceLadder asks_; //Best = lowest
     
-    //Fast order lookup
-    std::unordered_map<std::string, 
-        std::pair<Side, std::list<Order>::iterator>> order_lookup_;
+    //Resting order nodes and fast order lookup
+    OrderPool pool_;
+    OrderIndex order_lookup_;
+
+    //Set on a branch: the frozen book holding the queues of levels still marked shared.
+    //order_lookup_ then holds only this book's own nodes; other ids are looked up in
+    //base_ unless listed in removed_ (resting there but gone from this book).
+    std::shared_ptr<const OrderBook> base_;
+    std::unordered_set<OrderId> removed_;
+    size_t branch_depth_;
+
+    TradeBuffer pending_trades_; //Default sink, drained by matchOrders()
+    TradeSink* trade_sink_;      //External sink, if any
 
-    std::vector<Trade> pending_trades_; //Helps with matching
+    //Incremental market data, only built while a sink is installed
+    struct TopOfBook {
+        Price bid;
+        int64_t bid_size;
+        Price ask;
+        int64_t ask_size;
+    };
+    MarketDataSink* market_data_;
+    uint64_t market_data_sequence_; //Last sequence number sent
+    uint64_t market_data_time_;     //Timestamp for updates from the current operation
+    TopOfBook published_top_;       //Last TOP_OF_BOOK sent
 
     //Helper methods
+    OrderBook(std::shared_ptr<const OrderBook> base, size_t depth); //Branch, see branch()
     void addOrderToBook(const Order& order);
-    void removeOrderFromBook(const std::string& order_id);
-    void processMarketOrder(const Order& order);
-    std::string generateTradeId() const;
-    void addTrade(const Trade& trade);
+    void removeOrderFromBook(OrderId order_id);
+    void releaseNode(OrderNode* node);
+    const OrderNode* findNode(OrderId order_id) const;
+    OrderNode* findOwnNode(OrderId order_id); //Copies the node's level first if it is shared
+    void copySharedLevel(PriceLadder& ladder, Price price);
+    void shareSide(const PriceLadder& source, PriceLadder& ladder);
+    void absorbBases();
+    void uncross(uint64_t now);
+    void matchIncoming(Order& working_order, PriceLadder& book_side, Price limit);
+    int64_t availableQuantity(const PriceLadder& book_side, Side side, Price limit, int64_t needed) const;
+    uint64_t currentTime() const { return clock_ ? clock_->now() : 0; }
+    std::vector<std::pair<double, int>> getDepth(const PriceLadder& ladder, int levels) const;
+    int copyDepth(const PriceLadder& ladder, int levels, double* prices, int* quantities) const;
+    static void saveSide(const PriceLadder& ladder, ImageWriter& image);
+    void loadSide(PriceLadder& ladder, ImageReader& image);
+    void copySide(const PriceLadder& source, PriceLadder& ladder);
+    bool appendResting(PriceLevel& level, Price price, const Order& order); //False if the id was already resting
+    static constexpr double MAX_TICKS = 9007199254740992.0; //2^53: beyond this a price is not a usable tick count
+    Price toTicks(const Order& order) const; //NO_PRICE for a price that is not finite or is beyond MAX_TICKS
+    void publishBook();
+    void publishLevel(const PriceLadder& ladder, Price price, bool created);
+    void publishTrade(const Trade& trade, Side incoming_side);
+    void publishTop();
+    void publish(MarketDataUpdate& update);
+    template <typename Visitor>
+    static void visitSide(const PriceLadder& ladder, Visitor& visit) {
+        for (Price price = ladder.best(); price != PriceLadder::NO_PRICE; price = ladder.next(price)) {
+            for (const OrderNode* node = ladder.find(price)->front(); node; node = node->next) {
+                visit(node->order);
+            }
+        }
+    }
+    double toPrice(Price ticks) const { return ticks * tick_size_; }
+    TradeId nextTradeId() { return makeTradeId(symbol_, ++trade_sequence_); }
+    void addTrade(const Trade& trade) {
+        if (trade_sink_) {
+            trade_sink_->onTrade(trade);
+        } else {
+            pending_trades_.onTrade(trade);
+        }
+    }
 }; 
\ No newline at end of file
@@ -3,42 +3,234 @@
 #include "OrderBook.hpp"
 #include "Order.hpp"
 #include "Trade.hpp"
-#include <unordered_map>
+#include "IdInterner.hpp"
+#include "Clock.hpp"
+#include "ThreadPool.hpp"
+#include "AsyncEngine.hpp"
+#include "TradeTape.hpp"
+#include "Journal.hpp"
+#include <atomic>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
 
+//Caller-owned output columns for OrderBookManager::snapshot; row i describes symbols[i].
+//Depth columns hold `levels` entries per row, best first, zero-filled past the last level.
+//Any pointer may be null to skip that column; depth prices and quantities are skipped together.
+struct MarketSnapshot {
+    double* best_bid = nullptr; //0 when the side is empty, as getBestBid
+    double* best_ask = nullptr;
+    double* mid = nullptr;      //NaN unless both sides are quoted
+    double* spread = nullptr;   //NaN unless both sides are quoted
+    int* bid_size = nullptr;    //Total resting quantity per side
+    int* ask_size = nullptr;
+    double* bid_prices = nullptr;
+    int* bid_quantities = nullptr;
+    double* ask_prices = nullptr;
+    int* ask_quantities = nullptr;
+};
+
 class OrderBookManager {
 public:
-    OrderBookManager() = default;
+    //Interned string ids are numbered from here up, so callers may use their own
+    //integer ids below these bounds without colliding with named orders/clients
+    static constexpr OrderId INTERNED_ORDER_ID_BASE = OrderId(1) << 62;
+    static constexpr ClientId INTERNED_CLIENT_ID_BASE = ClientId(1) << 31;
+
+    OrderBookManager();
 
 
     //Main tools to manage Symbols
-    void addOrderBook(const std::string& symbol);
+    SymbolId addOrderBook(const std::string& symbol, double tick_size = 0.01);
     bool hasOrderBook(const std::string& symbol) const;
     void removeOrderBook(const std::string& symbol);
 
-    //-------Wrappers for individual orderbooks----------
+    //-------Wrappers for individual orderbooks (engine ids)----------
 
+    SubmitResult submitOrder(const Order& order); //REJECTED for an unknown book, never throws
     void placeOrder(const Order& order);
-    void cancelOrder(const std::string& symbol, const std::string& order_id);
-    std::vector<Trade> processOrders();
+    //Batch forms: results[i] / cancelled[i] describe entry i. Orders failing
+    //Order::validate or naming an unknown book are REJECTED, never thrown.
+    void submitOrders(const Order* orders, size_t count, SubmitResult* results);
+    void tryCancelOrders(const SymbolId* symbols, const OrderId* order_ids, size_t count, bool* cancelled);
+    bool tryCancelOrder(SymbolId symbol, OrderId order_id);
+    void cancelOrder(SymbolId symbol, OrderId order_id);
+    std::vector<Trade> processOrders(); //All books' trades in symbol id order
+
+    //Same pass without the merge: slot i holds book i's trades (empty for missing books).
+    //Valid until the next call.
+    const std::vector<std::vector<Trade>>& processOrdersByBook();
+
+    //Same pass written into a reusable column tape owned by the manager.
+    //The tape (and any views of its columns) is overwritten by the next call;
+    //column buffers the tape outgrows are kept, so old views never dangle.
+    const TradeTape& processOrdersToTape();
+
+    //Match books in parallel across a worker pool (1 = serial on the calling thread).
+    //With more than one worker an installed TradeSink is called from several threads.
+    void setWorkerThreads(size_t workers, Partition partition = Partition::STATIC, bool pin_threads = false);
+    size_t getWorkerThreads() const { return workers_ ? workers_->workerCount() : 1; }
+
+    double getBestBid(SymbolId symbol) const;
+    double getBestAsk(SymbolId symbol) const;
+    int getBidSize(SymbolId symbol) const;
+    int getAskSize(SymbolId symbol) const;
+    std::vector<std::pair<double, int>> getBidDepth(SymbolId symbol, int levels) const;
+    std::vector<std::pair<double, int>> getAskDepth(SymbolId symbol, int levels) const;
+    //Top of book, sizes and `levels` of depth for many books in one pass, without allocating.
+    //Throws for an unknown book (rows before it are already written).
+    void snapshot(const SymbolId* symbols, size_t count, int levels, const MarketSnapshot& out) const;
+
+    bool hasOrder(SymbolId symbol, OrderId order_id) const;
+    const Order* getOrder(SymbolId symbol, OrderId order_id) const;
+
+    //Per-book matching mode; trades from every book go to one sink (null = returned by processOrders)
+    void setMatchingMode(SymbolId symbol, MatchingMode mode);
+    MatchingMode getMatchingMode(SymbolId symbol) const;
+    void setTradeSink(TradeSink* sink);
+
+    //Incremental book updates from every book (see MarketData.hpp); null stops the feed.
+    //Installing a sink sends each book's CLEAR and current levels first. Not owned.
+    //Removing a book sends nothing; forks start without a sink.
+    void setMarketDataSink(MarketDataSink* sink);
+
+    //-------Async mode: orders go through per-shard rings to dedicated matching threads----------
+    //While running, the synchronous order/cancel/process calls throw and book queries
+    //are not synchronised with matching; read market data after stopAsync().
+
+    void startAsync(size_t shards, size_t queue_capacity = 1 << 16, bool pin_threads = false);
+    void stopAsync(); //Matches everything already posted; unpolled events stay pollable
+    bool isAsync() const { return async_ && async_->isRunning(); }
+    bool postOrder(const Order& order);                 //False if the shard queue is full
+    bool postCancel(SymbolId symbol, OrderId order_id); //Acked with a CANCEL_ACK event
+    size_t pollEvents(std::vector<EngineEvent>& out, size_t max_events = SIZE_MAX);
+
+    //-------State images: every book's levels, queues and resting orders plus the id tables----------
+    //Save between matching passes: trades not yet returned are not part of the image.
+    //Loading replaces all books and interned ids (books keep their symbol ids), bulk-building
+    //each queue in order without matching; on a bad image it throws and nothing changes.
+    //Clock, trade sink, worker threads and journal are not part of the image.
+
+    void saveSnapshot(std::vector<uint8_t>& image) const; //Appends to image
+    void loadSnapshot(const uint8_t* image, size_t size);
+    void saveSnapshot(const std::string& path) const;
+    void loadSnapshot(const std::string& path);
 
-    double getBestBid(const std::string& symbol) const;
-    double getBestAsk(const std::string& symbol) const;
-    int getBidSize(const std::string& symbol) const;
-    int getAskSize(const std::string& symbol) const;
-    std::vector<std::pair<double, int>> getBidDepth(const std::string& symbol, int levels) const;
-    std::vector<std::pair<double, int>> getAskDepth(const std::string& symbol, int levels) const;
+    //-------Forks: what-if branches sharing state with this manager----------
+    //A logically independent copy. Books and id tables stay shared until one side changes
+    //them, so a fork costs one pointer per book plus the clock. The first change to a
+    //shared book (on either side) branches it: O(price levels) for the level headers,
+    //then each level's queue is copied the first time that level changes; untouched
+    //levels and their orders are never copied (see OrderBook::branch). An id table is
+    //copied whole the first time a side interns a new string id. Once the other side
+    //lets go, a branched book takes the shared storage back in O(orders it changed).
+    //The branch gets a copy of the clock but no trade sink, worker pool or journal. A
+    //manager and its branches may be driven from different threads.
+    std::unique_ptr<OrderBookManager> fork() const;
+
+    //-------Journal: accepted orders, cancels and matching passes, appended in order----------
+    //Attaching writes the current books and their resting orders, so a replay of the
+    //journal rebuilds them and reproduces everything from that point on (attach between
+    //matching passes: trades not yet returned are not journalled, nor are trades
+    //delivered to an installed TradeSink). Null detaches, flushing the old journal.
+    //Async mode cannot run while a journal is attached.
+
+    void setJournal(std::unique_ptr<JournalWriter> journal);
+    JournalWriter* getJournal() { return journal_.get(); }
+
+    //Timestamp source shared by all books (steady clock by default)
+    void setClock(std::unique_ptr<Clock> clock);
+    Clock& getClock() { return *clock_; }
+    void setSimulationTime(double seconds); //Requires a SimulatedClock
+
+    //-------String edge: symbol names and interned order/client ids----------
+
+    SymbolId getSymbolId(const std::string& symbol) const; //Throws if no book exists
+    const std::string& getSymbolName(SymbolId symbol) const;
+
+    OrderId internOrderId(const std::string& order_id) { return unshare(order_ids_).intern(order_id); }
+    ClientId internClientId(const std::string& client_id) { return unshare(client_ids_).intern(client_id); }
+    bool findOrderId(const std::string& order_id, OrderId& id) const { return order_ids_->find(order_id, id); } //Never interns
+    std::string getOrderIdName(OrderId order_id) const;   //Falls back to the number itself
+    std::string getClientIdName(ClientId client_id) const;
+
+    bool tryCancelOrder(const std::string& symbol, const std::string& order_id);
+    void cancelOrder(const std::string& symbol, const std::string& order_id);
+    double getBestBid(const std::string& symbol) const { return getBestBid(getSymbolId(symbol)); }
+    double getBestAsk(const std::string& symbol) const { return getBestAsk(getSymbolId(symbol)); }
+    double getTickSize(const std::string& symbol) const;
+    void setMatchingMode(const std::string& symbol, MatchingMode mode) { setMatchingMode(getSymbolId(symbol), mode); }
+    MatchingMode getMatchingMode(const std::string& symbol) const { return getMatchingMode(getSymbolId(symbol)); }
+    int getBidSize(const std::string& symbol) const { return getBidSize(getSymbolId(symbol)); }
+    int getAskSize(const std::string& symbol) const { return getAskSize(getSymbolId(symbol)); }
+    std::vector<std::pair<double, int>> getBidDepth(const std::string& symbol, int levels) const {
+        return getBidDepth(getSymbolId(symbol), levels);
+    }
+    std::vector<std::pair<double, int>> getAskDepth(const std::string& symbol, int levels) const {
+        return getAskDepth(getSymbolId(symbol), levels);
+    }
+    OrderBook::AllocationStats getAllocationStats(const std::string& symbol) const;
 
     bool hasOrder(const std::string& symbol, const std::string& order_id) const;
     const Order* getOrder(const std::string& symbol, const std::string& order_id) const;
 
+    //The manager never takes this itself: callers sharing one manager between
+    //threads (the Python bindings) hold it around every call. Separate managers
+    //share no state, so each can be driven from its own thread.
+    std::mutex& apiMutex() const { return api_mutex_; }
+
 private:
-    //Map of symbol to OrderBook
-    std::unordered_map<std::string, std::unique_ptr<OrderBook>> orderbooks_;
+    mutable std::mutex api_mutex_;
+    std::unique_ptr<Clock> clock_;
+    TradeSink* trade_sink_; //Not owned
+    MarketDataSink* market_data_sink_; //Not owned
+
+    //Parallel matching: null pool runs books serially
+    std::unique_ptr<ThreadPool> workers_;
+    Partition partition_;
+    std::vector<std::vector<Trade>> book_trades_; //Per-book output of the last pass
+    TradeTape tape_;                              //Columnar output of the last pass
+
+    //Books indexed by SymbolId (slot 0 unused, removed books leave a null slot).
+    //Shared with forks until changed: mutate only through the non-const getOrderBook.
+    std::vector<std::shared_ptr<OrderBook>> orderbooks_;
+
+    //Declared after the books so it is torn down (and its threads joined) first
+    std::unique_ptr<AsyncEngine> async_;
+    std::unique_ptr<JournalWriter> journal_; //Null when not journalling
+
+    //Interning tables, only consulted by the string overloads (shared with forks like the books)
+    std::shared_ptr<IdInterner<SymbolId>> symbols_;
+    std::shared_ptr<IdInterner<OrderId>> order_ids_;
+    std::shared_ptr<IdInterner<ClientId>> client_ids_;
 
     //Helper methods
-    OrderBook* getOrderBook(const std::string& symbol);
-    const OrderBook* getOrderBook(const std::string& symbol) const;
-}; 
\ No newline at end of file
+    OrderBook* getOrderBook(SymbolId symbol); //Copies the book first if a fork shares it
+    const OrderBook* getOrderBook(SymbolId symbol) const;
+    OrderBook& requireOrderBook(SymbolId symbol);
+    const OrderBook& requireOrderBook(SymbolId symbol) const;
+    void requireSync() const;
+    //Copy-on-write for state shared with forks: copied before this manager changes it.
+    //The fence pairs with the release when another owner drops its reference.
+    template <typename T>
+    static T& unshare(std::shared_ptr<T>& state) {
+        if (state.use_count() > 1) {
+            state = std::make_shared<T>(*state);
+        } else {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *state;
+    }
+    //Books are branched rather than copied, and take their base back once it is unshared
+    static OrderBook& unshare(std::shared_ptr<OrderBook>& book) {
+        if (book.use_count() > 1) {
+            book = OrderBook::branch(book);
+        } else {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            book->reclaimBase();
+        }
+        return *book;
+    }
+    void journalEvent(JournalEvent event, SymbolId symbol, OrderId order_id = 0, double price = 0.0, int32_t quantity = 0);
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "PriceLevel.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Open-addressing (linear probing) map from order id to resting node.
+//Slots hold only the node pointer; the key is read from the node itself, so
+//inserting and erasing never allocate. The table only grows past 50% load.
+class OrderIndex {
+public:
+    explicit OrderIndex(size_t initial_capacity = 1024);
+
+    OrderNode* find(OrderId order_id) const;
+    void insert(OrderNode* node);  //Replaces any node with the same id
+    void erase(const OrderNode* node); //No-op unless the slot points at this node
+    void clear();
+    void reserve(size_t count); //Room for count ids without further rehashing
+
+    size_t size() const { return size_; }
+    uint64_t getRehashCount() const { return rehashes_; }
+
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const { //visit(OrderNode*) for every indexed node, in no particular order
+        for (OrderNode* node : slots_) {
+            if (node) visit(node);
+        }
+    }
+
+private:
+    std::vector<OrderNode*> slots_;
+    size_t mask_;
+    unsigned shift_; //64 - log2(slot count), for Fibonacci hashing
+    size_t size_;
+    uint64_t rehashes_;
+
+    size_t slotFor(OrderId order_id) const;
+    void grow();
+    void rehash(size_t capacity); //capacity is a power of two
+};
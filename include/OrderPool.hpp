@@ -0,0 +1,44 @@
+#pragma once
+
+#include "PriceLevel.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+//Slab allocator for resting order nodes. Nodes are handed out from a free list
+//and returned to it on fill/cancel, so once the book has warmed up the
+//add/cancel/match path never touches the heap. Slabs are only freed with the pool.
+class OrderPool {
+public:
+    //Counters for soak runs: slab_allocations should stop growing after warm-up
+    struct Stats {
+        uint64_t slab_allocations = 0; //Heap allocations made by the pool
+        uint64_t acquired = 0;         //Nodes handed out
+        uint64_t released = 0;         //Nodes given back
+        size_t capacity = 0;           //Nodes across all slabs
+        size_t in_use = 0;
+    };
+
+    explicit OrderPool(size_t slab_size = 1024);
+
+    OrderNode* acquire(const Order& order);
+    void release(OrderNode* node);
+    void reset(); //Return every node to the free list, keeping the slabs
+    void adopt(OrderPool& other); //Takes over other's slabs, nodes in use and free list; other ends up empty
+
+    const Stats& getStats() const { return stats_; }
+
+private:
+    struct Slab {
+        std::unique_ptr<OrderNode[]> nodes;
+        size_t size; //Adopted slabs keep their original size
+    };
+
+    size_t slab_size_;
+    std::vector<Slab> slabs_;
+    OrderNode* free_list_;
+    Stats stats_;
+
+    void addSlab();
+};
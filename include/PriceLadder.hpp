@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Order.hpp"
+#include "PriceLevel.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+//One side of the book as a dense array of price levels indexed by tick.
+//The array is centred on the first price seen and re-centred/grown when a price
+//falls outside it. Occupied levels are tracked in a hierarchical bitmap (64-way
+//per layer) so the best price and the next level are a few word scans away.
+class PriceLadder {
+public:
+    static constexpr Price NO_PRICE = std::numeric_limits<Price>::min();
+
+    explicit PriceLadder(Side side,
+                         size_t initial_levels = 4096,
+                         size_t max_levels = size_t(1) << 20);
+
+    //Level access
+    PriceLevel& getOrCreate(Price price); //Marks the level occupied
+    PriceLevel* find(Price price);
+    const PriceLevel* find(Price price) const;
+    void release(Price price); //Call once a level has become empty
+    bool canHold(Price price) const; //False if getOrCreate(price) would exceed max_levels
+
+    //Walking the side from the touch outwards
+    Price best() const;             //Highest bid / lowest ask, NO_PRICE if empty
+    Price next(Price price) const;  //Next occupied level further from the touch
+
+    bool empty() const { return occupied_ == 0; }
+    size_t levelCount() const { return occupied_; }
+    size_t occupiedSpan() const { return empty() ? 0 : highestIndex() - lowestIndex() + 1; } //Ticks from worst to best level
+
+    //Running totals for the whole side, maintained by the book alongside level updates
+    void adjustTotals(int64_t quantity, int orders) {
+        total_quantity_ += quantity;
+        order_count_ += orders;
+    }
+    int64_t totalQuantity() const { return total_quantity_; }
+    int64_t orderCount() const { return order_count_; }
+    Side getSide() const { return side_; }
+    void clear();
+
+private:
+    Side side_;
+    Price base_;          //Price of levels_[0]
+    size_t occupied_;
+    size_t max_levels_;
+    int64_t total_quantity_;
+    int64_t order_count_;
+
+    std::vector<PriceLevel> levels_;
+    std::vector<std::vector<uint64_t>> bits_; //bits_[0] = one bit per level, last layer = one word
+
+    //Helper methods
+    bool inRange(Price price) const;
+    bool isSet(size_t index) const;
+    void setBit(size_t index);
+    void clearBit(size_t index);
+    void buildLayers(size_t capacity);
+    void ensureRange(Price price);
+
+    size_t highestIndex() const;
+    size_t lowestIndex() const;
+    int64_t findBelow(size_t layer, size_t index) const;
+    int64_t findAbove(size_t layer, size_t index) const;
+    size_t descendHighest(size_t layer, size_t word) const;
+    size_t descendLowest(size_t layer, size_t word) const;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Order.hpp"
+
+//A resting order plus its intrusive FIFO links. Nodes are owned by OrderPool.
+struct OrderNode {
+    Order order;
+    Price price = 0; //Level the order rests at, in ticks
+    OrderNode* prev = nullptr;
+    OrderNode* next = nullptr;
+};
+
+//One price level of the book: intrusive FIFO queue of resting orders at a single tick.
+//Aggregates are kept up to date by pushBack/remove/fill so depth queries never walk orders.
+struct PriceLevel {
+    OrderNode* head = nullptr;
+    OrderNode* tail = nullptr;
+    int64_t total_quantity = 0;
+    int order_count = 0;
+    bool shared = false; //Queue belongs to the book this one was branched from: copy before changing it
+
+    bool empty() const { return head == nullptr; }
+    OrderNode* front() const { return head; }
+
+    void pushBack(OrderNode* node) {
+        node->prev = tail;
+        node->next = nullptr;
+        if (tail) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+        total_quantity += node->order.quantity;
+        order_count++;
+    }
+
+    void remove(OrderNode* node) {
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            head = node->next;
+        }
+        if (node->next) {
+            node->next->prev = node->prev;
+        } else {
+            tail = node->prev;
+        }
+        node->prev = nullptr;
+        node->next = nullptr;
+        total_quantity -= node->order.quantity;
+        order_count--;
+    }
+
+    void popFront() { remove(head); }
+
+    //Partial or full execution of a resting order; the node stays queued
+    void fill(OrderNode* node, int quantity) {
+        node->order.quantity -= quantity;
+        total_quantity -= quantity;
+    }
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//Bounded lock-free queues for handing messages between threads.
+//Capacity is rounded up to a power of two; push/pop never allocate and
+//report a full/empty queue instead of blocking.
+
+namespace ring_detail {
+constexpr size_t CACHE_LINE = 64;
+
+inline size_t roundUpPow2(size_t value) {
+    size_t capacity = 2;
+    while (capacity < value) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+} // namespace ring_detail
+
+//Single producer, single consumer. Each side keeps a cached copy of the other
+//side's index so the shared counters are only touched when the cache runs out.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : mask_(ring_detail::roundUpPow2(capacity) - 1),
+          slots_(new T[mask_ + 1]) {}
+
+    bool tryPush(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item) {
+        return popBatch(&item, 1) == 1;
+    }
+
+    //Pops up to max items into out, returns how many
+    size_t popBatch(T* out, size_t max) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (tail_cache_ == head) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+        }
+        size_t count = tail_cache_ - head;
+        if (count > max) count = max;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = slots_[(head + i) & mask_];
+        }
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+    bool emptyApprox() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(ring_detail::CACHE_LINE) std::atomic<size_t> head_{0}; //Consumer position
+    size_t tail_cache_ = 0;                                        //Consumer's view of tail_
+    alignas(ring_detail::CACHE_LINE) std::atomic<size_t> tail_{0}; //Producer position
+    size_t head_cache_ = 0;                                        //Producer's view of head_
+};
+
+//Multiple producers, single consumer. Bounded sequence-numbered slots:
+//producers claim a position with one CAS and publish through the slot's
+//sequence, so a slow producer never blocks others from claiming.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity)
+        : mask_(ring_detail::roundUpPow2(capacity) - 1),
+          slots_(new Slot[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const T& item) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; //Full: the consumer has not freed this slot yet
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = item;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item) {
+        return popBatch(&item, 1) == 1;
+    }
+
+    //Pops up to max published items in order; stops at the first slot still being written
+    size_t popBatch(T* out, size_t max) {
+        size_t count = 0;
+        while (count < max) {
+            Slot& slot = slots_[head_ & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                break;
+            }
+            out[count++] = slot.value;
+            slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            head_++;
+        }
+        return count;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(ring_detail::CACHE_LINE) std::atomic<size_t> tail_{0}; //Next position to claim
+    alignas(ring_detail::CACHE_LINE) size_t head_ = 0;             //Consumer only
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Agent.hpp"
+#include "OrderBookManager.hpp"
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+//Mirrors python/config.py, plus the seeding and fund-order constants simulation.py hard-codes
+struct SimulationConfig {
+    std::vector<std::string> symbols{"AAPL", "MSFT", "GOOGL"};
+    double tick_size = 0.01;
+
+    uint64_t num_steps = 1000;
+    double dt = 0.1; //Seconds per step
+
+    double fee_per_order = 0.01;
+    double fee_per_share = 0.002;
+
+    double latency_mean = 0.02; //Seconds from submission to arrival at the book
+    double latency_std = 0.01;
+
+    double fund_volatility = 0.1; //Std dev of the fundamental mid's per-step move
+    double initial_mid = 100.0;
+    double fund_half_spread = 0.05; //Fund quotes each step at mid +/- this
+    int fund_quantity = 1;
+
+    int seed_levels = 5; //Initial liquidity: seed_levels per side, seed_tick apart
+    double seed_tick = 1.0;
+    int seed_quantity = 10;
+
+    uint64_t record_interval = 1; //Record PnL/inventory/NAV every N steps, 0 = never
+    bool record_trades = false;   //Keep every trade and the step it happened in (see trades())
+    uint64_t seed = 0;            //Same seed and agents -> same run
+};
+
+using AgentId = uint32_t;
+
+struct AgentAccount {
+    std::string name;
+    SymbolId symbol;
+    ClientId client_id; //Agent id + 1; 0 is the fund/seed flow
+    double pnl = 0.0;
+    int64_t inventory = 0;
+    uint64_t trades = 0;
+};
+
+//The simulation.py main loop in C++: fundamental drift with fund quotes, a
+//latency queue of agent orders, agent steps, matching and PnL accounting.
+//Each step runs, in order:
+//  a) every fundamental mid drifts and the fund quotes around it
+//  b) agent orders whose arrival time has come reach the books (earliest first)
+//  c) each agent's onStep runs, in the order they were added
+//  d) all books are matched and trades are charged to the agents' accounts
+//  e) PnL, inventory and NAV are recorded every record_interval steps
+//A Simulation owns its books and RNG and is not thread-safe; separate instances are independent.
+class Simulation {
+public:
+    explicit Simulation(SimulationConfig config);
+
+    //Shared so the Python bindings can keep their own reference; agents step in the order added
+    AgentId addAgent(const std::string& name, SymbolId symbol, std::shared_ptr<Agent> agent);
+
+    void run(); //Remaining steps up to config.num_steps
+    void step();
+
+    //-------Order entry on an agent's behalf (what its OrderSink calls)----------
+
+    OrderId nextOrderId() { return next_order_id_++; } //Below the interned-id base
+    //Charges the per-order fee and queues the order to arrive after a sampled
+    //latency. client_id is overwritten with the agent's; the timestamp is set on arrival.
+    void submitOrder(AgentId agent, Order order);
+    //Immediate; false if the order has not arrived yet, already filled or is gone
+    bool cancelOrder(SymbolId symbol, OrderId order_id);
+
+    double getBestBid(SymbolId symbol) const { return manager_.getBestBid(symbol); }
+    double getBestAsk(SymbolId symbol) const { return manager_.getBestAsk(symbol); }
+    double getFundamentalMid(SymbolId symbol) const;
+    SymbolId getSymbolId(const std::string& symbol) const { return manager_.getSymbolId(symbol); }
+    const std::vector<SymbolId>& getSymbolIds() const { return symbol_ids_; }
+
+    double now() const { return step_ * config_.dt; } //Seconds
+    uint64_t currentStep() const { return step_; }
+
+    //-------Results----------
+
+    const SimulationConfig& getConfig() const { return config_; }
+    size_t agentCount() const { return agents_.size(); }
+    const AgentAccount& getAccount(AgentId agent) const { return agents_.at(agent).account; }
+
+    //History, one row per recorded step and one column per agent (row-major)
+    const std::vector<uint64_t>& recordedSteps() const { return recorded_steps_; }
+    const std::vector<double>& pnlHistory() const { return pnl_history_; }
+    const std::vector<int64_t>& inventoryHistory() const { return inventory_history_; }
+    const std::vector<double>& navHistory() const { return nav_history_; }
+
+    uint64_t ordersSubmitted() const { return orders_submitted_; }
+    uint64_t ordersRejected() const { return orders_rejected_; } //By the engine, on arrival
+    uint64_t tradeCount() const { return trade_count_; }
+    //Every trade so far in match order, with tradeSteps()[i] the step of trades().at(i); empty unless config.record_trades
+    const TradeTape& trades() const { return trades_; }
+    const std::vector<uint64_t>& tradeSteps() const { return trade_steps_; }
+
+    //Direct access to the books, e.g. for market data beyond the top of book
+    OrderBookManager& getManager() { return manager_; }
+    const OrderBookManager& getManager() const { return manager_; }
+
+private:
+    struct Participant {
+        AgentAccount account;
+        std::shared_ptr<Agent> agent;
+    };
+
+    //An agent's OrderSink: orders go through submitOrder under its id
+    class AgentOrders : public OrderSink {
+    public:
+        AgentOrders(Simulation& simulation, AgentId agent) : simulation_(simulation), agent_(agent) {}
+        OrderId nextOrderId() override { return simulation_.nextOrderId(); }
+        void submitOrder(const Order& order) override { simulation_.submitOrder(agent_, order); }
+        bool cancelOrder(SymbolId symbol, OrderId order_id) override { return simulation_.cancelOrder(symbol, order_id); }
+    private:
+        Simulation& simulation_;
+        AgentId agent_;
+    };
+
+    //An agent order in flight; ties on arrival time keep submission order
+    struct Arrival {
+        uint64_t time_ns;
+        uint64_t sequence;
+        Order order;
+    };
+    struct ArrivesLater {
+        bool operator()(const Arrival& a, const Arrival& b) const {
+            return a.time_ns != b.time_ns ? a.time_ns > b.time_ns : a.sequence > b.sequence;
+        }
+    };
+
+    SimulationConfig config_;
+    OrderBookManager manager_;
+    SimulatedClock* clock_; //Owned by manager_
+    std::mt19937_64 rng_;
+    std::normal_distribution<double> unit_normal_;
+
+    std::vector<SymbolId> symbol_ids_; //config.symbols order
+    std::vector<double> fundamental_;  //Indexed like symbol_ids_
+    std::vector<Participant> agents_;
+    std::priority_queue<Arrival, std::vector<Arrival>, ArrivesLater> arrivals_;
+
+    uint64_t step_;
+    OrderId next_order_id_;
+    uint64_t arrival_sequence_;
+
+    //Reused every step
+    std::vector<Order> fund_orders_;
+    std::vector<SubmitResult> fund_results_;
+
+    std::vector<uint64_t> recorded_steps_;
+    std::vector<double> pnl_history_;
+    std::vector<int64_t> inventory_history_;
+    std::vector<double> nav_history_;
+    TradeTape trades_;
+    std::vector<uint64_t> trade_steps_;
+
+    uint64_t orders_submitted_;
+    uint64_t orders_rejected_;
+    uint64_t trade_count_;
+
+    void seedBooks();
+    void quoteFundamentals(uint64_t now_ns);
+    void releaseArrivals(uint64_t now_ns);
+    void settle(const std::vector<std::vector<Trade>>& book_trades);
+    void record();
+    AgentAccount* accountFor(ClientId client_id);
+};
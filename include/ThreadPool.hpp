@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//How parallelFor hands out indices:
+//STATIC gives each worker one contiguous block (no shared counter, good cache locality),
+//DYNAMIC lets workers claim indices one at a time (evens out uneven per-index cost).
+enum class Partition : uint8_t { STATIC, DYNAMIC };
+
+//Fixed set of workers for fork/join loops. The calling thread takes part as
+//worker 0, so a pool of N workers starts N - 1 threads. One loop at a time.
+class ThreadPool {
+public:
+    using Task = std::function<void(size_t index, size_t worker)>;
+
+    //pin_threads binds each started thread (workers 1..N-1) to a CPU of its own (Linux only,
+    //ignored elsewhere). CPUs are numbered as the OS numbers them and handed out in order
+    //across every pinned pool in the process, from CPU 1 upwards and wrapping at
+    //hardware_concurrency(), so pools built one after another do not pin onto the same
+    //CPUs until they wrap. Worker 0 is whichever thread calls parallelFor and is never pinned.
+    explicit ThreadPool(size_t workers, bool pin_threads = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //Runs task(i, worker) for every i in [0, count) and returns once all are done.
+    //The first exception thrown by a task is rethrown here after the loop drains.
+    void parallelFor(size_t count, const Task& task, Partition partition = Partition::STATIC);
+
+    size_t workerCount() const { return threads_.size() + 1; }
+
+    //Best-effort affinity for the calling thread (CPU index wraps; no-op off Linux)
+    static void pinCurrentThread(size_t cpu);
+
+private:
+    std::vector<std::thread> threads_;
+
+    //Current loop, published under mutex_ and identified by generation_
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable work_done_;
+    uint64_t generation_;
+    size_t active_;
+    bool stopping_;
+
+    const Task* task_;
+    size_t count_;
+    Partition partition_;
+    std::atomic<size_t> next_index_;
+    std::exception_ptr error_;
+
+    void workerLoop(size_t worker);
+    void runShare(size_t worker);
+};
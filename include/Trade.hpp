@@ -1,33 +1,73 @@
 #pragma once
 
+#include "Order.hpp"
 #include <string>
-#include <chrono>
+
+//Trade ids are per-book sequence numbers packed with the book's symbol:
+//high 24 bits symbol id, low 40 bits sequence. Unique for the life of a book.
+using TradeId = uint64_t;
+
+constexpr int TRADE_SEQUENCE_BITS = 40;
+constexpr uint64_t TRADE_SEQUENCE_MASK = (uint64_t(1) << TRADE_SEQUENCE_BITS) - 1;
+
+inline TradeId makeTradeId(SymbolId symbol, uint64_t sequence) {
+    return (static_cast<uint64_t>(symbol) << TRADE_SEQUENCE_BITS) | (sequence & TRADE_SEQUENCE_MASK);
+}
+inline SymbolId tradeIdSymbol(TradeId id) { return static_cast<SymbolId>(id >> TRADE_SEQUENCE_BITS); }
+inline uint64_t tradeIdSequence(TradeId id) { return id & TRADE_SEQUENCE_MASK; }
+
+//Text form "<symbol>-<sequence in hex>", only built when a consumer asks for it
+inline std::string formatTradeId(TradeId id, const std::string& symbol_name) {
+    static const char* hex_digits = "0123456789ABCDEF";
+    char digits[16];
+    int length = 0;
+    uint64_t sequence = tradeIdSequence(id);
+    do {
+        digits[length++] = hex_digits[sequence & 0xF];
+        sequence >>= 4;
+    } while (sequence != 0 || length < 8);
+
+    std::string text;
+    text.reserve(symbol_name.size() + 1 + length);
+    text += symbol_name;
+    text += '-';
+    while (length > 0) {
+        text += digits[--length];
+    }
+    return text;
+}
 
 struct Trade {
-    std::string trade_id;
-    std::string symbol;
-    double price;
+    TradeId trade_id;
+    SymbolId symbol;
     int quantity;
-    std::string buy_order_id;
-    std::string sell_order_id;
+    double price;
+    OrderId buy_order_id;
+    OrderId sell_order_id;
+    ClientId buyer_client_id;
+    ClientId seller_client_id;
     uint64_t timestamp;
 
     // Constructor
-    Trade(const std::string& trade_id,
-          const std::string& symbol,
+    Trade(TradeId trade_id,
+          SymbolId symbol,
           double price,
           int quantity,
-          const std::string& buy_order_id,
-          const std::string& sell_order_id)
+          OrderId buy_order_id,
+          OrderId sell_order_id,
+          uint64_t timestamp = 0,
+          ClientId buyer_client_id = 0,
+          ClientId seller_client_id = 0)
         : trade_id(trade_id),
           symbol(symbol),
-          price(price),
           quantity(quantity),
+          price(price),
           buy_order_id(buy_order_id),
           sell_order_id(sell_order_id),
-          timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
-              std::chrono::system_clock::now().time_since_epoch()).count()) {}
+          buyer_client_id(buyer_client_id),
+          seller_client_id(seller_client_id),
+          timestamp(timestamp) {}
 
     // Default constructor
     Trade() = default;
-}; 
\ No newline at end of file
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Trade.hpp"
+#include <vector>
+
+//Receives trades as a book produces them. Books hold a non-owning pointer;
+//with no sink installed they buffer into a TradeBuffer drained by matchOrders().
+class TradeSink {
+public:
+    virtual ~TradeSink() = default;
+    virtual void onTrade(const Trade& trade) = 0;
+};
+
+//Collects trades in arrival order until taken
+class TradeBuffer : public TradeSink {
+public:
+    void onTrade(const Trade& trade) override { trades_.push_back(trade); }
+
+    //Hands over everything buffered so far and leaves the buffer empty
+    std::vector<Trade> take() {
+        std::vector<Trade> taken = std::move(trades_);
+        trades_.clear();
+        return taken;
+    }
+
+    bool empty() const { return trades_.empty(); }
+    size_t size() const { return trades_.size(); }
+    void clear() { trades_.clear(); }
+
+private:
+    std::vector<Trade> trades_;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Trade.hpp"
+#include "TradeSink.hpp"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+//Trades stored column by column (structure of arrays) so a whole step's output
+//can be handed to NumPy as a handful of contiguous buffers. clear() keeps the
+//capacity, so a tape reused across steps stops allocating once it has warmed up.
+//Column buffers are never freed while the tape lives: when a column outgrows its
+//capacity the old buffer is retired rather than released, so a view taken before
+//the growth still points at valid (if stale) memory.
+class TradeTape : public TradeSink {
+public:
+    void onTrade(const Trade& trade) override { append(trade); }
+
+    void append(const Trade& trade) {
+        if (price_.size() == price_.capacity()) {
+            reserve(std::max<size_t>(64, 2 * price_.size()));
+        }
+        symbol_.push_back(trade.symbol);
+        sequence_.push_back(tradeIdSequence(trade.trade_id));
+        price_.push_back(trade.price);
+        quantity_.push_back(trade.quantity);
+        buy_order_id_.push_back(trade.buy_order_id);
+        sell_order_id_.push_back(trade.sell_order_id);
+        buyer_client_id_.push_back(trade.buyer_client_id);
+        seller_client_id_.push_back(trade.seller_client_id);
+        timestamp_.push_back(trade.timestamp);
+    }
+
+    void append(const std::vector<Trade>& trades) {
+        reserve(size() + trades.size());
+        for (const Trade& trade : trades) {
+            append(trade);
+        }
+    }
+
+    void reserve(size_t capacity) {
+        grow(symbol_, capacity);
+        grow(sequence_, capacity);
+        grow(price_, capacity);
+        grow(quantity_, capacity);
+        grow(buy_order_id_, capacity);
+        grow(sell_order_id_, capacity);
+        grow(buyer_client_id_, capacity);
+        grow(seller_client_id_, capacity);
+        grow(timestamp_, capacity);
+    }
+
+    void clear() {
+        symbol_.clear();
+        sequence_.clear();
+        price_.clear();
+        quantity_.clear();
+        buy_order_id_.clear();
+        sell_order_id_.clear();
+        buyer_client_id_.clear();
+        seller_client_id_.clear();
+        timestamp_.clear();
+    }
+
+    size_t size() const { return price_.size(); }
+    bool empty() const { return price_.empty(); }
+
+    //Row i rebuilt as a Trade
+    Trade at(size_t i) const {
+        return Trade(makeTradeId(symbol_[i], sequence_[i]), symbol_[i], price_[i], quantity_[i],
+                     buy_order_id_[i], sell_order_id_[i], timestamp_[i],
+                     buyer_client_id_[i], seller_client_id_[i]);
+    }
+
+    //Column access. Contents are overwritten when the tape is next cleared or appended
+    //to, but a column's data() stays readable for as long as the tape exists
+    const std::vector<SymbolId>& symbols() const { return symbol_; }
+    const std::vector<uint64_t>& sequences() const { return sequence_; }
+    const std::vector<double>& prices() const { return price_; }
+    const std::vector<int>& quantities() const { return quantity_; }
+    const std::vector<OrderId>& buyOrderIds() const { return buy_order_id_; }
+    const std::vector<OrderId>& sellOrderIds() const { return sell_order_id_; }
+    const std::vector<ClientId>& buyerClientIds() const { return buyer_client_id_; }
+    const std::vector<ClientId>& sellerClientIds() const { return seller_client_id_; }
+    const std::vector<uint64_t>& timestamps() const { return timestamp_; }
+
+private:
+    //Reallocate by hand so the outgrown buffer is kept (in retired_) instead of freed.
+    //Growth at least doubles, so retired buffers add up to less than the live ones.
+    template <typename T>
+    void grow(std::vector<T>& column, size_t capacity) {
+        if (capacity <= column.capacity()) {
+            return;
+        }
+        auto larger = std::make_shared<std::vector<T>>();
+        larger->reserve(std::max(capacity, 2 * column.capacity()));
+        larger->assign(column.begin(), column.end());
+        column.swap(*larger);
+        retired_.push_back(std::move(larger)); //Now holds the old buffer
+    }
+
+    std::vector<SymbolId> symbol_;
+    std::vector<uint64_t> sequence_; //Per-book trade sequence (see tradeIdSequence)
+    std::vector<double> price_;
+    std::vector<int> quantity_;
+    std::vector<OrderId> buy_order_id_;
+    std::vector<OrderId> sell_order_id_;
+    std::vector<ClientId> buyer_client_id_;
+    std::vector<ClientId> seller_client_id_;
+    std::vector<uint64_t> timestamp_;
+    std::vector<std::shared_ptr<void>> retired_; //Outgrown column buffers, see grow()
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "NativeAgents.hpp"
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct VecEnvConfig {
+    SimulationConfig simulation; //The learner trades the first symbol; seed and record_interval are set per episode
+    AgentMix background;         //Native agents sharing the books with the learner
+    uint64_t episode_length = 1000;
+    int order_size = 1;
+};
+
+//N independent simulations, each with one externally controlled learner, stepped
+//together. Actions are the RLAgent's: HOLD, or a market BUY/SELL of order_size.
+//
+//Observation (OBSERVATION_DIM floats per env): one-step mid return, spread,
+//bid size, ask size and the learner's inventory, all on the learner's book.
+//Reward: change in the learner's marked NAV (PnL incl. fees + inventory * mid).
+//
+//An env that finishes its episode reports done and is reset at once with the next
+//seed of its sequence, so its observation row already belongs to the new episode.
+//Output buffers are owned here and overwritten by every reset()/step().
+class VecEnv {
+public:
+    enum Action : int32_t { HOLD = 0, BUY = 1, SELL = 2 };
+    static constexpr size_t OBSERVATION_DIM = 5;
+
+    VecEnv(VecEnvConfig config, size_t envs, size_t workers = 1, bool pin_threads = false);
+    ~VecEnv();
+
+    VecEnv(const VecEnv&) = delete;
+    VecEnv& operator=(const VecEnv&) = delete;
+
+    void reset(const uint64_t* seeds); //One seed per env
+    void step(const int32_t* actions); //One action per env; anything else is HOLD
+
+    size_t size() const { return envs_.size(); }
+    //Output buffers: sized in the constructor and never reallocated, so their data()
+    //stays valid for the VecEnv's lifetime (contents change on every reset()/step())
+    const std::vector<float>& observations() const { return observations_; } //size() x OBSERVATION_DIM
+    const std::vector<float>& rewards() const { return rewards_; }
+    const std::vector<uint8_t>& dones() const { return dones_; }
+
+private:
+    class Learner;
+
+    struct Env {
+        std::unique_ptr<Simulation> simulation;
+        std::shared_ptr<Learner> learner;
+        AgentId learner_id = 0;
+        SymbolId symbol = 0;
+        uint64_t seed = 0;    //From the last reset()
+        uint64_t episode = 0; //Episodes since then
+        double previous_mid = 0.0;
+        double previous_nav = 0.0;
+    };
+
+    VecEnvConfig config_;
+    std::vector<Env> envs_;
+    std::unique_ptr<ThreadPool> workers_;
+
+    std::vector<float> observations_;
+    std::vector<float> rewards_;
+    std::vector<uint8_t> dones_;
+
+    void startEpisode(size_t index); //Seeded from the env seed and episode number
+    void stepEnv(size_t index, int32_t action);
+    void observe(size_t index);
+    double markedNav(const Env& env, double mid) const;
+};
@@ -15,4 +15,13 @@ LATENCY_MEAN = 0.02
 LATENCY_STD  = 0.01     #10 ms jitter
 
 #Fundamental price drift volatility/step ...
-FUND_VOLATILITY = 0.1
\ No newline at end of file
+FUND_VOLATILITY = 0.1
+
+#Print every trade (recorded by the engine during the run, printed after it)
+PRINT_TRADES = True
+
+#Seed for the engine RNG (fund drift, latency): same seed, same run
+SEED = 42
+
+#Run the rule-based agents (MM, TF, MR, LT) as their native C++ ports
+NATIVE_AGENTS = True
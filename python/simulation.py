@@ -4,7 +4,6 @@ import os
 import sys
 import glob
 import importlib.util
-import random
 import pandas as pd
 
 import config
@@ -31,67 +30,64 @@ _orderbook = importlib.util.module_from_spec(spec)
 spec.loader.exec_module(_orderbook)
 sys.modules["orderbook"] = _orderbook
 
-from orderbook import OrderBookManager, Order, Side, OrderType
-
-#INITIALLY SEED THE ORDERBOOK WITH DUMMY DATA TO ENSURE LIQUIDITY
-def seed_order_book(mgr, symbol, levels=5, size=10, tick=1.0):
-    mid = 100.0
-    for i in range(1, levels + 1):
-        mgr.place_order(Order(f"seed-b-{symbol}-{i}", "seeder",
-                              symbol, Side.BUY,  mid - i*tick, size, OrderType.LIMIT))
-        mgr.place_order(Order(f"seed-s-{symbol}-{i}", "seeder",
-                              symbol, Side.SELL, mid + i*tick, size, OrderType.LIMIT))
-
-
-#Manager proxy for latency & per-order fees...
-CURRENT_TIME = 0.0
+import orderbook
+from orderbook import Simulation, SimulationConfig, Agent
+
+#The main loop (fund drift and quotes, latency queue, matching, PnL) runs natively;
+#Python is only entered for the agents still written in Python
+sim_config = SimulationConfig()
+sim_config.symbols         = config.SYMBOLS
+sim_config.num_steps       = config.NUM_STEPS
+sim_config.dt              = config.DT
+sim_config.fee_per_order   = config.FEE_PER_ORDER
+sim_config.fee_per_share   = config.FEE_PER_SHARE
+sim_config.latency_mean    = config.LATENCY_MEAN
+sim_config.latency_std     = config.LATENCY_STD
+sim_config.fund_volatility = config.FUND_VOLATILITY
+sim_config.seed            = config.SEED
+sim_config.record_trades   = config.PRINT_TRADES
+
+sim = Simulation(sim_config)
+
+
+#Runs one of the Python agents in orderbook_agents. They were written against a manager
+#(get_best_bid/get_best_ask/place_order/cancel_order with string ids), so this adapter
+#plays that role for the duration of each on_step.
+class PythonAgent(Agent):
+    def __init__(self, cls, symbol, client_id):
+        Agent.__init__(self)
+        self.market    = None
+        self.orders    = None
+        self.order_ids = {}   # agent's string id -> engine order id
+        self.agent     = cls(self, symbol, client_id=client_id)
 
-class ManagerProxy:
-    def __init__(self, real_mgr, agent_wrapper):
-        self._mgr   = real_mgr
-        self._agent = agent_wrapper
+    def on_step(self, market, orders):
+        self.market, self.orders = market, orders
+        self.agent.step()
 
     def get_best_bid(self, sym):
-        return self._mgr.get_best_bid(sym)
+        return self.market.best_bid()
     def get_best_ask(self, sym):
-        return self._mgr.get_best_ask(sym)
-
-    def cancel_order(self, sym, oid):
-        try:
-            return self._mgr.cancel_order(sym, oid)
-        except RuntimeError:
-            return
-
-    def place_order(self, order):
-        latency   = max(0.0, random.gauss(config.LATENCY_MEAN, config.LATENCY_STD))
-        exec_time = CURRENT_TIME + latency
-        delayed_orders.append((exec_time, order, self._agent))
-        self._agent.pnl -= config.FEE_PER_ORDER
-
-
-
-class AgentWrapper: #USED TO HOLD STATE FOR EACH AGENT
-    def __init__(self, cls, symbol, client_id):
-        self.real_mgr   = real_mgr
-        self.pnl         = 0.0
-        self.inventory   = 0
-        self.symbol      = symbol
-        self.client_id   = client_id
-
-        self.proxy      = ManagerProxy(real_mgr, self)
-        self.agent      = cls(self.proxy, symbol, client_id=client_id)
+        return self.market.best_ask()
 
+    def place_order(self, order): #engine charges the fee and delays it by the sampled latency
+        #Interned so trades print under the agent's own id (get_order_id_name)
+        self.order_ids[order.order_id] = self.orders.submit_order(
+            self.market.symbol, order.side, order.price, order.quantity, order.type, order.tif,
+            sim.intern_order_id(order.order_id))
 
-# Initialize everything...
-real_mgr        = OrderBookManager()
-delayed_orders  = []      # (exec_time, order, wrapper)
-order_map       = {}      # order_id -> wrapper
+    def cancel_order(self, sym, oid): #False if not arrived yet, already filled or gone
+        engine_id = self.order_ids.pop(oid, None)
+        return engine_id is not None and self.orders.cancel_order(self.market.symbol, engine_id)
 
-config._base_mid = {sym: 100.0 for sym in config.SYMBOLS}
 
-for sym in config.SYMBOLS:
-    real_mgr.add_order_book(sym)
-    seed_order_book(real_mgr, sym)
+#Rule-based strategies with native ports (same parameters) skip Python entirely
+native_agents = {
+    "MarketMakerAgent":    lambda i: orderbook.MarketMakerAgent(),
+    "TrendFollowerAgent":  lambda i: orderbook.TrendFollowerAgent(),
+    "MeanReverterAgent":   lambda i: orderbook.MeanReverterAgent(),
+    "LiquidityTakerAgent": lambda i: orderbook.LiquidityTakerAgent(seed=config.SEED + i),
+}
 
 agent_plan = [
     ("MM", 2, "market_maker",    "MarketMakerAgent"),
@@ -104,100 +100,43 @@ agent_plan = [
 
 agents = []
 for tag, count, module_name, class_name in agent_plan:
-    m = importlib.import_module(f"orderbook_agents.{module_name}")
-    AgentClass = getattr(m, class_name)
     for i in range(count):
         sym = config.SYMBOLS[len(agents) % len(config.SYMBOLS)]
         cid = f"{tag}-{i}"
-        wrapper = AgentWrapper(AgentClass, sym, client_id=cid)
-        agents.append(wrapper)
-
-# Prepare history buffers and trade counters for the agents...
-steps          = []
-pnl_history    = {ag.client_id: [] for ag in agents}
-inv_history    = {ag.client_id: [] for ag in agents}
-nav_history    = {ag.client_id: [] for ag in agents}
-trade_counts   = {ag.client_id: 0  for ag in agents}
-
-
-# MAIN SIMULATION LOOP!
-for step in range(config.NUM_STEPS):
-    CURRENT_TIME = step * config.DT
-
-    #a) First, fundamental mid‐price drift + light reseed
-    for sym in config.SYMBOLS:
-        config._base_mid[sym] += random.gauss(0, config.FUND_VOLATILITY)
-        m = config._base_mid[sym]
-        real_mgr.place_order(Order(f"fund-b-{sym}-{step}", "fund",
-                                   sym, Side.BUY,  m - 0.05, 1, OrderType.LIMIT))
-        real_mgr.place_order(Order(f"fund-s-{sym}-{step}", "fund",
-                                   sym, Side.SELL, m + 0.05, 1, OrderType.LIMIT))
-
-    #b) Now release delayed orders
-    for exec_t, order, agent in list(delayed_orders):
-        if exec_t <= CURRENT_TIME:
-            try:
-                real_mgr.place_order(order)
-                order_map[order.order_id] = agent
-            except RuntimeError as e:
-                if "liquidity" in str(e).lower():
-                    pass
-                else:
-                    raise
-            finally:
-                delayed_orders.remove((exec_t, order, agent))
-
-    #c) step agents
-    for agent in agents:
-        agent.agent.step() # allows the agents to do what they want as per orderbook state
-
-    #d) match and collect trades from this step...
-    trades = real_mgr.process_orders()
-    for tr in trades: #process trades individually
-        buyer  = order_map.get(tr.buy_order_id)
-        seller = order_map.get(tr.sell_order_id)
-
-        #update statistics for buyer and seller to ensure everything outputted in metrics.csv
-        if buyer:
-            buyer.pnl         -= tr.quantity * tr.price
-            buyer.pnl         -= config.FEE_PER_SHARE * tr.quantity
-            buyer.inventory   += tr.quantity
-            trade_counts[buyer.client_id] += 1
-
-        if seller:
-            seller.pnl        += tr.quantity * tr.price
-            seller.pnl        -= config.FEE_PER_SHARE * tr.quantity
-            seller.inventory  -= tr.quantity
-            trade_counts[seller.client_id] += 1
-
-        print(f"[step {step}] TRADE {tr.quantity}@{tr.price} "
-              f"(buy:{tr.buy_order_id}, sell:{tr.sell_order_id})")
-
-    #record aforementioned metrics
-    steps.append(step)
-    for ag in agents:
-        pnl_history[ag.client_id].append(ag.pnl)
-        inv_history[ag.client_id].append(ag.inventory)
-        bid = real_mgr.get_best_bid(ag.symbol)
-        ask = real_mgr.get_best_ask(ag.symbol)
-        mid = (bid + ask) / 2
-        nav_history[ag.client_id].append(ag.pnl + ag.inventory * mid)
+        if config.NATIVE_AGENTS and class_name in native_agents:
+            agent = native_agents[class_name](len(agents))
+        else:
+            m = importlib.import_module(f"orderbook_agents.{module_name}")
+            agent = PythonAgent(getattr(m, class_name), sym, cid)
+        sim.add_agent(cid, sym, agent)
+        agents.append(agent)
+
+
+# MAIN SIMULATION LOOP! (in C++)
+sim.run()
+accounts = sim.accounts()
+history  = sim.history()
+
+if config.PRINT_TRADES:
+    trades = sim.trades()
+    for step, q, p, b, s_ in zip(sim.trade_steps(), trades.quantity, trades.price, trades.buy_order_id, trades.sell_order_id):
+        print(f"[step {step}] TRADE {q}@{p} "
+              f"(buy:{sim.get_order_id_name(int(b))}, sell:{sim.get_order_id_name(int(s_))})")
 
 #Summaries...
 print("\n--- Final P&L, Inventory, Trades, Return/Trade ---")
-for ag in agents:
-    cnt   = trade_counts[ag.client_id]
-    pnl   = ag.pnl
-    rpt   = (pnl / cnt) if cnt > 0 else float("nan")
-    print(f"{ag.client_id:<8}  P&L={pnl:8.2f}  Inv={ag.inventory:3d}  "
+for cid, pnl, inv, cnt in zip(accounts["name"], accounts["pnl"], accounts["inventory"], accounts["trades"]):
+    rpt = (pnl / cnt) if cnt > 0 else float("nan")
+    print(f"{cid:<8}  P&L={pnl:8.2f}  Inv={inv:3d}  "
           f"Trades={cnt:3d}  Return/Trade={rpt:8.2f}")
+print(f"{sim.orders_submitted()} agent orders, {sim.orders_rejected()} rejected, {sim.trade_count()} trades")
 
 #Summary pt2 for graphs
-df = pd.DataFrame({"step": steps})
-for cid in pnl_history:
-    df[f"{cid}_pnl"]  = pnl_history[cid]
-    df[f"{cid}_inv"]  = inv_history[cid]
-    df[f"{cid}_nav"]  = nav_history[cid]
+df = pd.DataFrame({"step": history["step"]})
+for col, cid in enumerate(accounts["name"]):
+    df[f"{cid}_pnl"]  = history["pnl"][:, col]
+    df[f"{cid}_inv"]  = history["inventory"][:, col]
+    df[f"{cid}_nav"]  = history["nav"][:, col]
 
 out_path = os.path.join(here, "metrics.csv")
 df.to_csv(out_path, index=False)
@@ -0,0 +1,212 @@
+#include "AsyncEngine.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+AsyncEngine::AsyncEngine(const std::vector<OrderBook*>& books,
+                         size_t shards,
+                         size_t queue_capacity,
+                         bool pin_threads)
+    : books_(books),
+      previous_sinks_(books.size(), nullptr),
+      dirty_(books.size(), 0),
+      running_(false),
+      stopping_(false),
+      closed_(false),
+      posting_(0) {
+    if (shards == 0) {
+        throw std::invalid_argument("AsyncEngine needs at least one shard");
+    }
+
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; i++) {
+        shards_.push_back(std::make_unique<Shard>(*this, queue_capacity));
+    }
+
+    //Hand each book to its shard: trades now go straight to that shard's egress ring
+    for (size_t symbol = 0; symbol < books_.size(); symbol++) {
+        OrderBook* book = books_[symbol];
+        if (!book) continue;
+        Shard& shard = shardFor(static_cast<SymbolId>(symbol));
+        previous_sinks_[symbol] = book->getTradeSink();
+        book->setTradeSink(&shard.sink);
+        shard.books.push_back(book);
+    }
+
+    running_.store(true, std::memory_order_release);
+    for (size_t i = 0; i < shards_.size(); i++) {
+        Shard& shard = *shards_[i];
+        shard.thread = std::thread([this, &shard, i, pin_threads] { run(shard, i, pin_threads); });
+    }
+}
+
+AsyncEngine::~AsyncEngine() {
+    stop();
+}
+
+bool AsyncEngine::postOrder(const Order& order) {
+    return post(OrderMessage{OrderMessage::Kind::SUBMIT, order});
+}
+
+bool AsyncEngine::postCancel(SymbolId symbol, OrderId order_id) {
+    OrderMessage message{OrderMessage::Kind::CANCEL, Order()};
+    message.order.order_id = order_id;
+    message.order.symbol = symbol;
+    return post(message);
+}
+
+bool AsyncEngine::post(const OrderMessage& message) {
+    //posting_ lets stop() wait out producers that passed the check before it closed the rings
+    posting_.fetch_add(1);
+    bool posted = !stopping_.load() && shardFor(message.order.symbol).ingress.tryPush(message);
+    posting_.fetch_sub(1);
+    return posted;
+}
+
+size_t AsyncEngine::pollEvents(std::vector<EngineEvent>& out, size_t max_events) {
+    size_t polled = 0;
+
+    //Events collected by stop() come first, they are older than anything in the rings
+    if (!leftover_.empty()) {
+        size_t count = std::min(max_events, leftover_.size());
+        out.insert(out.end(), leftover_.begin(), leftover_.begin() + count);
+        leftover_.erase(leftover_.begin(), leftover_.begin() + count);
+        polled += count;
+    }
+
+    EngineEvent batch[DRAIN_BATCH];
+    for (auto& shard : shards_) {
+        while (polled < max_events) {
+            size_t count = shard->egress.popBatch(batch, std::min(DRAIN_BATCH, max_events - polled));
+            if (count == 0) break;
+            out.insert(out.end(), batch, batch + count);
+            polled += count;
+        }
+    }
+    return polled;
+}
+
+void AsyncEngine::stop() {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    stopping_.store(true);
+    while (posting_.load() != 0) {
+        std::this_thread::yield();
+    }
+    closed_.store(true, std::memory_order_release); //Nothing more can enter the rings
+
+    //Keep draining egress so a matcher blocked on a full ring can finish its queue
+    EngineEvent batch[DRAIN_BATCH];
+    bool all_finished = false;
+    while (!all_finished) {
+        all_finished = true;
+        for (auto& shard : shards_) {
+            size_t count;
+            while ((count = shard->egress.popBatch(batch, DRAIN_BATCH)) > 0) {
+                leftover_.insert(leftover_.end(), batch, batch + count);
+            }
+            if (!shard->finished.load(std::memory_order_acquire)) {
+                all_finished = false;
+            }
+        }
+        if (!all_finished) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& shard : shards_) {
+        shard->thread.join();
+        size_t count;
+        while ((count = shard->egress.popBatch(batch, DRAIN_BATCH)) > 0) {
+            leftover_.insert(leftover_.end(), batch, batch + count);
+        }
+    }
+
+    for (size_t symbol = 0; symbol < books_.size(); symbol++) {
+        if (books_[symbol]) books_[symbol]->setTradeSink(previous_sinks_[symbol]);
+    }
+    stopping_.store(false);
+    running_.store(false, std::memory_order_release);
+}
+
+//------------ Matching threads ----------------
+
+void AsyncEngine::run(Shard& shard, size_t cpu, bool pin_thread) {
+    if (pin_thread) {
+        ThreadPool::pinCurrentThread(cpu);
+    }
+
+    std::vector<OrderMessage> batch(DRAIN_BATCH);
+    size_t idle_passes = 0;
+    for (;;) {
+        size_t count = shard.ingress.popBatch(batch.data(), batch.size());
+        if (count == 0) {
+            //Once closed_ is set no producer is mid-push, so an empty ring is final
+            if (closed_.load(std::memory_order_acquire)) {
+                count = shard.ingress.popBatch(batch.data(), batch.size());
+                if (count == 0) break;
+            } else {
+                if (++idle_passes > 64) {
+                    std::this_thread::yield(); //Spin briefly for bursts, then give the core back
+                }
+                continue;
+            }
+        }
+        idle_passes = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            process(shard, batch[i]);
+        }
+
+        //The end of a drained batch is the batch boundary for BATCH-mode books
+        for (OrderBook* book : shard.touched) {
+            book->matchOrders(); //Trades go out through the shard sink
+            dirty_[book->getSymbol()] = 0;
+        }
+        shard.touched.clear();
+    }
+    shard.finished.store(true, std::memory_order_release);
+}
+
+void AsyncEngine::process(Shard& shard, const OrderMessage& message) {
+    const Order& order = message.order;
+    OrderBook* book = order.symbol < books_.size() ? books_[order.symbol] : nullptr;
+
+    EngineEvent ack{};
+    ack.symbol = order.symbol;
+    ack.order_id = order.order_id;
+
+    if (message.kind == OrderMessage::Kind::SUBMIT) {
+        ack.type = EventType::ORDER_ACK;
+        ack.result = book ? book->submitOrder(order) : SubmitResult{SubmitStatus::REJECTED, 0, order.quantity};
+        if (book && book->getMatchingMode() == MatchingMode::BATCH && !dirty_[order.symbol]) {
+            dirty_[order.symbol] = 1;
+            shard.touched.push_back(book);
+        }
+    } else {
+        ack.type = EventType::CANCEL_ACK;
+        const Order* resting = book ? book->getOrder(order.order_id) : nullptr;
+        int remaining = resting ? resting->quantity : 0;
+        ack.result = resting && book->tryCancelOrder(order.order_id)
+            ? SubmitResult{SubmitStatus::CANCELLED, 0, remaining}
+            : SubmitResult{SubmitStatus::REJECTED, 0, 0};
+    }
+    publish(shard, ack);
+}
+
+//Egress is bounded: a matcher that outruns the poller waits rather than dropping events
+void AsyncEngine::publish(Shard& shard, const EngineEvent& event) {
+    while (!shard.egress.tryPush(event)) {
+        std::this_thread::yield();
+    }
+}
+
+void AsyncEngine::ShardSink::onTrade(const Trade& trade) {
+    EngineEvent event{};
+    event.type = EventType::TRADE;
+    event.symbol = trade.symbol;
+    event.order_id = 0;
+    event.trade = trade;
+    engine_.publish(shard_, event);
+}
@@ -0,0 +1,157 @@
+#include "EngineStats.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+//Every block ever handed out, plus the ones whose thread has exited and can be reused.
+//The mutex is only taken when a thread records for the first time, exits, or a reader merges.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadStats>> blocks;
+    std::vector<ThreadStats*> free_blocks;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry(); //Never destroyed: threads may exit after static teardown
+    return *instance;
+}
+
+uint64_t load(const std::atomic<uint64_t>& value) {
+    return value.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+const char* statsOpName(StatsOp op) {
+    switch (op) {
+        case StatsOp::ADD: return "add";
+        case StatsOp::CANCEL: return "cancel";
+        case StatsOp::MATCH: return "match";
+        case StatsOp::MARKET: return "market";
+        case StatsOp::SNAPSHOT: return "snapshot";
+        default: return "unknown";
+    }
+}
+
+const char* statsCounterName(StatsCounter counter) {
+    switch (counter) {
+        case StatsCounter::ORDERS: return "orders";
+        case StatsCounter::TRADES: return "trades";
+        case StatsCounter::LEVELS_CREATED: return "levels_created";
+        case StatsCounter::LEVELS_DESTROYED: return "levels_destroyed";
+        case StatsCounter::REJECTS: return "rejects";
+        default: return "unknown";
+    }
+}
+
+uint64_t LatencyHistogram::bucketValue(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t sub = static_cast<uint64_t>((bucket - SUB_BUCKETS) % SUB_BUCKETS);
+    uint64_t low = (SUB_BUCKETS + sub) << shift;
+    return low + ((uint64_t{1} << shift) >> 1);
+}
+
+void LatencyHistogram::addTotals(uint64_t count, uint64_t sum, uint64_t max) {
+    count_ += count;
+    sum_ += sum;
+    if (max > max_) max_ = max;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t bucket_total = 0;
+    for (uint64_t count : counts_) bucket_total += count;
+    //Rank over the buckets rather than count_, which a concurrent reset can skew
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(bucket_total) + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts_[bucket];
+        if (seen >= rank) {
+            return std::min(bucketValue(bucket), max_); //Never report above the largest sample
+        }
+    }
+    return max_;
+}
+
+ThreadStats* acquireThreadStats() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (!reg.free_blocks.empty()) {
+        ThreadStats* block = reg.free_blocks.back();
+        reg.free_blocks.pop_back();
+        return block;
+    }
+    reg.blocks.push_back(std::make_unique<ThreadStats>());
+    return reg.blocks.back().get();
+}
+
+void releaseThreadStats(ThreadStats* block) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.free_blocks.push_back(block);
+}
+
+LatencyHistogram readHistogram(StatsOp op) {
+    LatencyHistogram merged;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& block : reg.blocks) {
+        const ThreadStats::Op& source = block->ops[static_cast<size_t>(op)];
+        for (int bucket = 0; bucket < LatencyHistogram::BUCKETS; bucket++) {
+            merged.add(bucket, load(source.buckets[bucket]));
+        }
+        merged.addTotals(load(source.count), load(source.sum), load(source.max));
+    }
+    return merged;
+}
+
+EngineStats readEngineStats() {
+    EngineStats stats;
+#if ORDERBOOK_STATS
+    stats.enabled = true;
+    for (size_t op = 0; op < stats.latency.size(); op++) {
+        LatencyHistogram histogram = readHistogram(static_cast<StatsOp>(op));
+        LatencySummary& summary = stats.latency[op];
+        summary.count = histogram.count();
+        summary.mean_ns = histogram.mean();
+        summary.p50_ns = histogram.percentile(0.50);
+        summary.p90_ns = histogram.percentile(0.90);
+        summary.p99_ns = histogram.percentile(0.99);
+        summary.p999_ns = histogram.percentile(0.999);
+        summary.max_ns = histogram.max();
+    }
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& block : reg.blocks) {
+        for (size_t counter = 0; counter < stats.counters.size(); counter++) {
+            stats.counters[counter] += load(block->counters[counter]);
+        }
+        stats.peak_depth = std::max(stats.peak_depth, load(block->peak_depth));
+    }
+#endif
+    return stats;
+}
+
+void resetEngineStats() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& block : reg.blocks) {
+        for (ThreadStats::Op& op : block->ops) {
+            for (auto& bucket : op.buckets) bucket.store(0, std::memory_order_relaxed);
+            op.count.store(0, std::memory_order_relaxed);
+            op.sum.store(0, std::memory_order_relaxed);
+            op.max.store(0, std::memory_order_relaxed);
+        }
+        for (auto& counter : block->counters) counter.store(0, std::memory_order_relaxed);
+        block->peak_depth.store(0, std::memory_order_relaxed);
+    }
+}
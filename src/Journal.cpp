@@ -0,0 +1,333 @@
+#include "Journal.hpp"
+#include "OrderBookManager.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char JOURNAL_MAGIC[8] = {'O', 'B', 'J', 'R', 'N', 'L', 0, 0};
+
+//------------ Writer ----------------
+
+JournalWriter::JournalWriter(const std::string& path, size_t batch_records)
+    : path_(path),
+      file_(nullptr),
+      batch_records_(batch_records),
+      next_sequence_(0),
+      stopping_(false) {
+    if (batch_records == 0) {
+        throw std::invalid_argument("Journal batch size must be positive");
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Cannot open journal for writing: " + path);
+    }
+
+    JournalHeader header{};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.record_size = sizeof(JournalRecord);
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+        std::fclose(file_);
+        throw std::runtime_error("Cannot write journal header: " + path);
+    }
+
+    active_.reserve(batch_records);
+    pending_.reserve(batch_records);
+    writer_ = std::thread(&JournalWriter::writerLoop, this);
+}
+
+JournalWriter::~JournalWriter() {
+    try {
+        flush();
+    } catch (...) {
+        //Destructors must not throw; call flush() first to see write errors
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    batch_ready_.notify_one();
+    writer_.join();
+    std::fclose(file_);
+}
+
+void JournalWriter::appendOrder(const Order& order, uint64_t timestamp) {
+    JournalRecord record{};
+    record.timestamp = timestamp;
+    record.order_id = order.order_id;
+    record.other_id = order.client_id;
+    record.price = order.price;
+    record.symbol = order.symbol;
+    record.quantity = order.quantity;
+    record.event = JournalEvent::ADD;
+    record.side = order.side;
+    record.type = order.type;
+    record.tif = order.tif;
+    append(record);
+}
+
+void JournalWriter::appendTrade(const Trade& trade) {
+    JournalRecord record{};
+    record.timestamp = trade.timestamp;
+    record.order_id = trade.buy_order_id;
+    record.other_id = trade.sell_order_id;
+    record.price = trade.price;
+    record.symbol = trade.symbol;
+    record.quantity = trade.quantity;
+    record.event = JournalEvent::TRADE;
+    append(record);
+}
+
+void JournalWriter::appendEvent(JournalEvent event, SymbolId symbol, uint64_t timestamp,
+                                OrderId order_id, double price, int32_t quantity) {
+    JournalRecord record{};
+    record.timestamp = timestamp;
+    record.order_id = order_id;
+    record.price = price;
+    record.symbol = symbol;
+    record.quantity = quantity;
+    record.event = event;
+    append(record);
+}
+
+void JournalWriter::flush() {
+    if (!active_.empty()) {
+        handOff();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    batch_written_.wait(lock, [this] { return pending_.empty(); });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    if (std::fflush(file_) != 0) {
+        throw std::runtime_error("Cannot flush journal: " + path_);
+    }
+}
+
+//Swaps the full batch over to the writer thread, waiting only if the previous
+//batch is still being written
+void JournalWriter::handOff() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        batch_written_.wait(lock, [this] { return pending_.empty(); });
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        pending_.swap(active_);
+    }
+    batch_ready_.notify_one();
+}
+
+void JournalWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        batch_ready_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return; //Stopping with nothing left to write
+        }
+
+        //pending_ is ours until it is cleared, so write it without the lock
+        lock.unlock();
+        size_t written = std::fwrite(pending_.data(), sizeof(JournalRecord), pending_.size(), file_);
+        lock.lock();
+
+        if (written != pending_.size() && !error_) {
+            error_ = std::make_exception_ptr(std::runtime_error("Cannot write journal: " + path_));
+        }
+        pending_.clear();
+        batch_written_.notify_all();
+    }
+}
+
+//------------ Reader ----------------
+
+JournalReader::JournalReader(const std::string& path)
+    : records_(nullptr), count_(0), mapping_(nullptr), mapped_size_(0) {
+    const char* data = nullptr;
+    size_t size = 0;
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open journal: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read journal: " + path);
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map journal: " + path);
+        }
+        ::madvise(mapped, size, MADV_SEQUENTIAL);
+        mapping_ = mapped;
+        mapped_size_ = size;
+        data = static_cast<const char*>(mapped);
+    }
+    ::close(fd); //The mapping keeps the file alive
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Cannot open journal: " + path);
+    }
+    size = static_cast<size_t>(file.tellg());
+    std::vector<char> contents(size);
+    file.seekg(0);
+    file.read(contents.data(), static_cast<std::streamsize>(size));
+    data = contents.data();
+#endif
+
+    JournalHeader header;
+    if (size < sizeof(header)) {
+        unmap();
+        throw std::runtime_error("Not a journal (too short): " + path);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0) {
+        unmap();
+        throw std::runtime_error("Not a journal (bad magic): " + path);
+    }
+    if (header.version != JOURNAL_VERSION || header.record_size != sizeof(JournalRecord)) {
+        unmap();
+        throw std::runtime_error("Unsupported journal version " + std::to_string(header.version) + ": " + path);
+    }
+
+    //A torn record at the end (writer killed mid-batch) is ignored
+    count_ = (size - sizeof(header)) / sizeof(JournalRecord);
+    if (mapping_) {
+        records_ = reinterpret_cast<const JournalRecord*>(data + sizeof(header));
+    } else {
+        fallback_.resize(count_);
+        std::memcpy(fallback_.data(), data + sizeof(header), count_ * sizeof(JournalRecord));
+        records_ = fallback_.data();
+    }
+}
+
+JournalReader::~JournalReader() {
+    unmap();
+}
+
+void JournalReader::unmap() {
+#ifndef _WIN32
+    if (mapping_) {
+        ::munmap(mapping_, mapped_size_);
+        mapping_ = nullptr;
+    }
+#endif
+}
+
+//------------ Replay ----------------
+
+//Walks the target's per-book trades in the order the journal wrote them
+class ReplayedTrades {
+public:
+    void reset(const std::vector<std::vector<Trade>>* books) {
+        books_ = books;
+        book_ = 0;
+        index_ = 0;
+    }
+
+    const Trade* next() {
+        while (books_ && book_ < books_->size()) {
+            const auto& trades = (*books_)[book_];
+            if (index_ < trades.size()) {
+                return &trades[index_++];
+            }
+            book_++;
+            index_ = 0;
+        }
+        return nullptr;
+    }
+
+private:
+    const std::vector<std::vector<Trade>>* books_ = nullptr;
+    size_t book_ = 0;
+    size_t index_ = 0;
+};
+
+ReplayStats replayJournal(const JournalReader& journal, OrderBookManager& target) {
+    auto owned_clock = std::make_unique<SimulatedClock>();
+    SimulatedClock& clock = *owned_clock;
+    target.setClock(std::move(owned_clock));
+
+    ReplayStats stats;
+    ReplayedTrades replayed;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const JournalRecord& record : journal) {
+        clock.setTime(record.timestamp);
+        switch (record.event) {
+        case JournalEvent::BOOK: {
+            SymbolId id = target.addOrderBook(std::to_string(record.symbol), record.price);
+            if (id != record.symbol) {
+                throw std::runtime_error("Replay target must start without books (symbol id "
+                                         + std::to_string(record.symbol) + " became "
+                                         + std::to_string(id) + ")");
+            }
+            break;
+        }
+        case JournalEvent::REMOVE_BOOK:
+            target.removeOrderBook(target.getSymbolName(record.symbol));
+            break;
+        case JournalEvent::MODE:
+            target.setMatchingMode(record.symbol, static_cast<MatchingMode>(record.quantity));
+            break;
+        case JournalEvent::ADD: {
+            Order order;
+            order.order_id = record.order_id;
+            order.client_id = static_cast<ClientId>(record.other_id);
+            order.symbol = record.symbol;
+            order.price = record.price;
+            order.quantity = record.quantity;
+            order.side = record.side;
+            order.type = record.type;
+            order.tif = record.tif;
+            order.timestamp = 0;
+            target.submitOrder(order);
+            stats.orders++;
+            break;
+        }
+        case JournalEvent::CANCEL:
+            target.tryCancelOrder(record.symbol, record.order_id);
+            stats.cancels++;
+            break;
+        case JournalEvent::BATCH: {
+            const auto& book_trades = target.processOrdersByBook();
+            for (const auto& trades : book_trades) {
+                stats.replay_trades += trades.size();
+            }
+            replayed.reset(&book_trades);
+            stats.batches++;
+            break;
+        }
+        case JournalEvent::TRADE: {
+            const Trade* trade = replayed.next();
+            if (!trade || trade->buy_order_id != record.order_id || trade->sell_order_id != record.other_id
+                || trade->quantity != record.quantity || trade->price != record.price
+                || trade->timestamp != record.timestamp) {
+                stats.mismatched_trades++;
+            }
+            stats.journal_trades++;
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown journal event at sequence " + std::to_string(record.sequence));
+        }
+        stats.records++;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
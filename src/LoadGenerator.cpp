@@ -0,0 +1,272 @@
+#include "LoadGenerator.hpp"
+#include "Clock.hpp"
+#include "OrderBookManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool isProbability(double p) {
+    return p >= 0.0 && p <= 1.0;
+}
+
+} // namespace
+
+LoadGenerator::LoadGenerator(const LoadConfig& config, uint64_t seed)
+    : config_(config),
+      rng_state_(seed),
+      next_order_id_(1),
+      time_ns_(0),
+      time_s_(0.0),
+      hawkes_excess_(0.0) {
+    if (config.symbols == 0 || config.symbols > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Load generator needs between 1 and 2^32 - 1 symbols");
+    }
+    if (config.tick_size <= 0 || config.start_price <= 0) {
+        throw std::invalid_argument("Tick size and start price must be positive");
+    }
+    if (config.rate <= 0) {
+        throw std::invalid_argument("Arrival rate must be positive");
+    }
+    if (config.arrivals == ArrivalProcess::HAWKES
+        && (config.hawkes_branching < 0 || config.hawkes_branching >= 1 || config.hawkes_decay <= 0)) {
+        throw std::invalid_argument("Hawkes arrivals need branching in [0, 1) and a positive decay");
+    }
+    double total_weight = config.limit_weight + config.market_weight + config.cancel_weight;
+    if (config.limit_weight < 0 || config.market_weight < 0 || config.cancel_weight < 0 || total_weight <= 0) {
+        throw std::invalid_argument("Message mix weights must be non-negative with a positive total");
+    }
+    if (!isProbability(config.marketable_prob) || !isProbability(config.ioc_prob) || !isProbability(config.walk_prob)) {
+        throw std::invalid_argument("Probabilities must be in [0, 1]");
+    }
+    if (config.passive_mean_ticks < 0 || config.spread_ticks < 1) {
+        throw std::invalid_argument("Passive offset must be non-negative and the spread at least one tick");
+    }
+    if (config.min_quantity < 1 || config.max_quantity < config.min_quantity || config.clients == 0) {
+        throw std::invalid_argument("Quantities need 1 <= min <= max and there must be at least one client");
+    }
+
+    limit_cut_ = config.limit_weight / total_weight;
+    market_cut_ = (config.limit_weight + config.market_weight) / total_weight;
+    //Geometric on {0, 1, ...} with mean m has P(k > n) = (m / (1 + m))^(n + 1).
+    //The table stops where the tail is negligible, capping offsets far behind the touch.
+    double ratio = config.passive_mean_ticks / (1.0 + config.passive_mean_ticks);
+    double tail = ratio;
+    while (tail > 1e-12 && offset_cdf_.size() < 100000) {
+        offset_cdf_.push_back(static_cast<uint64_t>((1.0 - tail) * 0x1.0p64));
+        tail *= ratio;
+    }
+
+    Price mid = std::max<Price>(static_cast<Price>(std::llround(config.start_price / config.tick_size)),
+                                config.spread_ticks + 1);
+    symbols_.resize(config.symbols);
+    for (size_t i = 0; i < symbols_.size(); i++) {
+        SymbolState& symbol = symbols_[i];
+        symbol.id = static_cast<SymbolId>(i + 1);
+        symbol.bid = mid - config.spread_ticks / 2;
+        symbol.ask = symbol.bid + config.spread_ticks;
+    }
+}
+
+void LoadGenerator::generate(LoadMessage* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        nextMessage(out[i]);
+    }
+}
+
+//Poisson: exponential gaps. Hawkes: exact simulation of an exponential-kernel
+//process (Dassios and Zhao, 2013), which needs no thinning loop
+double LoadGenerator::nextGap() {
+    if (config_.arrivals == ArrivalProcess::POISSON) {
+        return -std::log1p(-uniform()) / config_.rate;
+    }
+    double beta = config_.hawkes_decay;
+    double baseline = config_.rate * (1.0 - config_.hawkes_branching);
+    double gap = -std::log1p(-uniform()) / baseline; //Next immigrant
+    if (hawkes_excess_ > 0) {
+        double d = 1.0 + beta * std::log1p(-uniform()) / hawkes_excess_;
+        if (d > 0) {
+            gap = std::min(gap, -std::log(d) / beta); //Next child of the current burst
+        }
+    }
+    hawkes_excess_ = hawkes_excess_ * std::exp(-beta * gap) + config_.hawkes_branching * beta;
+    return gap;
+}
+
+void LoadGenerator::nextMessage(LoadMessage& message) {
+    time_s_ += nextGap();
+    time_ns_ = static_cast<uint64_t>(time_s_ * 1e9);
+    message.time_ns = time_ns_;
+
+    SymbolState& symbol = symbols_[below(static_cast<uint32_t>(symbols_.size()))];
+    if (config_.walk_prob > 0 && uniform() < config_.walk_prob) {
+        Price step = (draw() & 1) ? 1 : -1;
+        if (symbol.bid + step >= 1) {
+            symbol.bid += step;
+            symbol.ask += step;
+        }
+    }
+
+    double kind = uniform();
+    if (kind >= market_cut_ && !symbol.live.empty()) {
+        size_t index = below(static_cast<uint32_t>(symbol.live.size()));
+        message.action = LoadAction::CANCEL;
+        message.order = Order();
+        message.order.order_id = symbol.live[index];
+        message.order.symbol = symbol.id;
+        symbol.live[index] = symbol.live.back();
+        symbol.live.pop_back();
+        return;
+    }
+    message.action = LoadAction::ORDER;
+    makeOrder(symbol, message);
+    if (kind >= limit_cut_ && kind < market_cut_) {
+        message.order.type = OrderType::MARKET;
+        message.order.tif = TimeInForce::GTC;
+        message.order.price = 0.0;
+    } else if (message.order.tif == TimeInForce::GTC) {
+        rememberOrder(symbol, message.order.order_id);
+    }
+}
+
+//A limit order; nextMessage turns it into a market order where the mix says so
+void LoadGenerator::makeOrder(SymbolState& symbol, LoadMessage& message) {
+    uint64_t bits = draw();
+    Order& order = message.order;
+    order.order_id = next_order_id_++;
+    order.client_id = 1 + static_cast<ClientId>(((bits >> 32) * config_.clients) >> 32);
+    order.symbol = symbol.id;
+    order.side = (bits & 1) ? Side::BUY : Side::SELL;
+    order.type = OrderType::LIMIT;
+    order.tif = config_.ioc_prob > 0 && uniform() < config_.ioc_prob ? TimeInForce::IOC : TimeInForce::GTC;
+    order.quantity = config_.min_quantity
+        + static_cast<int>(below(static_cast<uint32_t>(config_.max_quantity - config_.min_quantity) + 1));
+    order.timestamp = 0;
+
+    Price ticks;
+    if (config_.marketable_prob > 0 && uniform() < config_.marketable_prob) {
+        ticks = order.isBuy() ? symbol.ask : symbol.bid; //Takes the opposite touch
+    } else {
+        Price offset = std::upper_bound(offset_cdf_.begin(), offset_cdf_.end(), draw()) - offset_cdf_.begin();
+        ticks = order.isBuy() ? symbol.bid - offset : symbol.ask + offset;
+    }
+    order.price = static_cast<double>(std::max<Price>(ticks, 1)) * config_.tick_size;
+}
+
+void LoadGenerator::rememberOrder(SymbolState& symbol, OrderId order_id) {
+    if (symbol.live.size() < MAX_LIVE) {
+        symbol.live.push_back(order_id);
+    } else {
+        symbol.live[below(static_cast<uint32_t>(MAX_LIVE))] = order_id;
+    }
+}
+
+void LoadGenerator::addBooks(OrderBookManager& manager) {
+    for (size_t i = 0; i < symbols_.size(); i++) {
+        SymbolId id = manager.addOrderBook("LOAD" + std::to_string(i), config_.tick_size);
+        manager.setMatchingMode(id, config_.mode);
+        symbols_[i].id = id;
+    }
+}
+
+void LoadGenerator::observe(const OrderBookManager& manager) {
+    for (SymbolState& symbol : symbols_) {
+        double bid = manager.getBestBid(symbol.id); //0 when the side is empty
+        double ask = manager.getBestAsk(symbol.id);
+        if (bid > 0 && ask > 0) {
+            symbol.bid = static_cast<Price>(std::llround(bid / config_.tick_size));
+            symbol.ask = static_cast<Price>(std::llround(ask / config_.tick_size));
+        }
+    }
+}
+
+LoadStats LoadGenerator::drive(OrderBookManager& manager, uint64_t messages, size_t batch) {
+    batch = std::max<size_t>(batch, 1);
+    auto owned_clock = std::make_unique<SimulatedClock>(time_ns_);
+    SimulatedClock& clock = *owned_clock;
+    manager.setClock(std::move(owned_clock));
+
+    LoadStats stats;
+    std::vector<LoadMessage> buffer(batch);
+    while (stats.messages < messages) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(batch, messages - stats.messages));
+        auto start = std::chrono::steady_clock::now();
+        generate(buffer.data(), count);
+        stats.generate_seconds += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            const LoadMessage& message = buffer[i];
+            clock.setTime(message.time_ns);
+            if (message.action == LoadAction::ORDER) {
+                stats.orders++;
+                if (manager.submitOrder(message.order).status == SubmitStatus::REJECTED) {
+                    stats.rejects++;
+                }
+            } else {
+                stats.cancels++;
+                if (!manager.tryCancelOrder(message.order.symbol, message.order.order_id)) {
+                    stats.cancels_missed++;
+                }
+            }
+        }
+        //Matches BATCH books and drains the trades CONTINUOUS books buffered
+        for (const auto& trades : manager.processOrdersByBook()) {
+            stats.trades += trades.size();
+        }
+        stats.batches++;
+        stats.engine_seconds += secondsSince(start);
+        stats.messages += count;
+
+        start = std::chrono::steady_clock::now();
+        observe(manager);
+        stats.generate_seconds += secondsSince(start);
+    }
+    return stats;
+}
+
+LoadStats LoadGenerator::writeJournal(JournalWriter& journal, uint64_t messages, size_t batch) {
+    batch = std::max<size_t>(batch, 1);
+    for (const SymbolState& symbol : symbols_) {
+        journal.appendEvent(JournalEvent::BOOK, symbol.id, time_ns_, 0, config_.tick_size);
+        journal.appendEvent(JournalEvent::MODE, symbol.id, time_ns_, 0, 0.0, static_cast<int32_t>(config_.mode));
+    }
+
+    LoadStats stats;
+    std::vector<LoadMessage> buffer(batch);
+    while (stats.messages < messages) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(batch, messages - stats.messages));
+        auto start = std::chrono::steady_clock::now();
+        generate(buffer.data(), count);
+        stats.generate_seconds += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            const LoadMessage& message = buffer[i];
+            if (message.action == LoadAction::ORDER) {
+                journal.appendOrder(message.order, message.time_ns);
+                stats.orders++;
+            } else {
+                journal.appendEvent(JournalEvent::CANCEL, message.order.symbol, message.time_ns,
+                                    message.order.order_id);
+                stats.cancels++;
+            }
+        }
+        journal.appendEvent(JournalEvent::BATCH, 0, time_ns_);
+        stats.batches++;
+        stats.engine_seconds += secondsSince(start);
+        stats.messages += count;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    journal.flush();
+    stats.engine_seconds += secondsSince(start);
+    return stats;
+}
@@ -0,0 +1,68 @@
+#include "MonteCarlo.hpp"
+#include <cstdlib>
+
+void MonteCarloResults::resize(size_t runs) {
+    scenario.resize(runs);
+    seed.resize(runs);
+    trades.resize(runs);
+    orders_submitted.resize(runs);
+    orders_rejected.resize(runs);
+    market_maker_pnl.resize(runs);
+    trend_follower_pnl.resize(runs);
+    mean_reverter_pnl.resize(runs);
+    liquidity_taker_pnl.resize(runs);
+    gross_inventory.resize(runs);
+    fundamental_drift.resize(runs);
+}
+
+//Runs one scenario/seed pair and writes its row
+static void runOne(const Scenario& scenario, uint32_t scenario_index, uint64_t seed,
+                   MonteCarloResults& results, size_t row) {
+    SimulationConfig config = scenario.config;
+    config.seed = seed;
+    config.record_interval = 0;
+    Simulation simulation(config);
+
+    const std::vector<SymbolId>& symbols = simulation.getSymbolIds();
+    std::vector<AgentKind> kinds = addAgentMix(simulation, scenario.agents, seed);
+
+    simulation.run();
+
+    double pnl[4] = {0.0, 0.0, 0.0, 0.0}; //By AgentKind
+    int64_t gross_inventory = 0;
+    for (AgentId agent = 0; agent < simulation.agentCount(); agent++) {
+        const AgentAccount& account = simulation.getAccount(agent);
+        pnl[static_cast<size_t>(kinds[agent])] += account.pnl;
+        gross_inventory += std::llabs(account.inventory);
+    }
+    double drift = 0.0;
+    for (SymbolId symbol : symbols) {
+        drift += simulation.getFundamentalMid(symbol) - config.initial_mid;
+    }
+
+    results.scenario[row] = scenario_index;
+    results.seed[row] = seed;
+    results.trades[row] = simulation.tradeCount();
+    results.orders_submitted[row] = simulation.ordersSubmitted();
+    results.orders_rejected[row] = simulation.ordersRejected();
+    results.market_maker_pnl[row] = pnl[static_cast<size_t>(AgentKind::MARKET_MAKER)];
+    results.trend_follower_pnl[row] = pnl[static_cast<size_t>(AgentKind::TREND_FOLLOWER)];
+    results.mean_reverter_pnl[row] = pnl[static_cast<size_t>(AgentKind::MEAN_REVERTER)];
+    results.liquidity_taker_pnl[row] = pnl[static_cast<size_t>(AgentKind::LIQUIDITY_TAKER)];
+    results.gross_inventory[row] = gross_inventory;
+    results.fundamental_drift[row] = drift / symbols.size();
+}
+
+MonteCarloResults runMonteCarlo(const std::vector<Scenario>& scenarios,
+                                const std::vector<uint64_t>& seeds,
+                                ThreadPool& pool) {
+    MonteCarloResults results;
+    results.resize(scenarios.size() * seeds.size());
+
+    //Rows are preallocated, so workers write disjoint slots without locking
+    pool.parallelFor(results.size(), [&](size_t run, size_t) {
+        size_t scenario = run / seeds.size();
+        runOne(scenarios[scenario], static_cast<uint32_t>(scenario), seeds[run % seeds.size()], results, run);
+    }, Partition::DYNAMIC);
+    return results;
+}
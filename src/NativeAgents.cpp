@@ -0,0 +1,160 @@
+#include "NativeAgents.hpp"
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+static Order marketOrder(OrderSink& orders, SymbolId symbol, Side side, int size) {
+    return Order(orders.nextOrderId(), 0, symbol, side, 0.0, size, OrderType::MARKET);
+}
+
+//------------ Market maker ----------------
+
+MarketMakerAgent::MarketMakerAgent(double spread, int size)
+    : spread_(spread), size_(size), bid_id_(0), ask_id_(0) {
+    if (size <= 0) {
+        throw std::invalid_argument("Quote size must be positive");
+    }
+}
+
+void MarketMakerAgent::onStep(const MarketView& market, OrderSink& orders) {
+    if (bid_id_ != 0) orders.cancelOrder(market.symbol, bid_id_);
+    if (ask_id_ != 0) orders.cancelOrder(market.symbol, ask_id_);
+    bid_id_ = 0;
+    ask_id_ = 0;
+
+    double mid = market.mid();
+    double half_spread = spread_ / 2;
+    double net_edge = half_spread * size_ - market.fee_per_share * size_;
+
+    //Only quote if the edge covers the per-order fee and the bid stays above 0
+    if (net_edge < market.fee_per_order || mid <= half_spread) {
+        return;
+    }
+
+    bid_id_ = orders.nextOrderId();
+    ask_id_ = orders.nextOrderId();
+    orders.submitOrder(Order(bid_id_, 0, market.symbol, Side::BUY, mid - half_spread, size_));
+    orders.submitOrder(Order(ask_id_, 0, market.symbol, Side::SELL, mid + half_spread, size_));
+}
+
+//------------ Trend follower ----------------
+
+TrendFollowerAgent::TrendFollowerAgent(int lookback, double threshold, int size)
+    : lookback_(lookback), threshold_(threshold), size_(size) {
+    if (lookback <= 0 || size <= 0) {
+        throw std::invalid_argument("Lookback and size must be positive");
+    }
+}
+
+void TrendFollowerAgent::onStep(const MarketView& market, OrderSink& orders) {
+    double mid = market.mid();
+    mids_.push_back(mid);
+    if (mids_.size() > static_cast<size_t>(lookback_) + 1) {
+        mids_.pop_front();
+    }
+    if (mids_.size() <= static_cast<size_t>(lookback_)) {
+        return;
+    }
+
+    double previous = mids_.front();
+    if (previous <= 0.0) { //Missing previous mid
+        return;
+    }
+    double ret = (mid - previous) / previous;
+
+    double gross_edge = std::abs(ret) * mid * size_;
+    double total_cost = market.fee_per_share * size_ + market.fee_per_order;
+    if (std::abs(ret) < threshold_ || gross_edge < total_cost) {
+        return;
+    }
+    orders.submitOrder(marketOrder(orders, market.symbol, ret > 0 ? Side::BUY : Side::SELL, size_));
+}
+
+//------------ Mean reverter ----------------
+
+MeanReverterAgent::MeanReverterAgent(int lookback, double threshold, int size)
+    : lookback_(lookback), threshold_(threshold), size_(size) {
+    if (lookback <= 0 || size <= 0) {
+        throw std::invalid_argument("Lookback and size must be positive");
+    }
+}
+
+void MeanReverterAgent::onStep(const MarketView& market, OrderSink& orders) {
+    double mid = market.mid();
+    mids_.push_back(mid);
+    if (mids_.size() > static_cast<size_t>(lookback_) + 1) {
+        mids_.pop_front();
+    }
+    if (mids_.size() < static_cast<size_t>(lookback_) + 1) {
+        return;
+    }
+
+    //Rolling average excluding the newest mid
+    double average = std::accumulate(mids_.begin(), mids_.end() - 1, 0.0) / lookback_;
+    double deviation = std::abs(mid - average);
+    double total_cost = market.fee_per_share + market.fee_per_order / size_;
+    if (deviation < threshold_ * average + total_cost) {
+        return;
+    }
+    orders.submitOrder(marketOrder(orders, market.symbol, mid > average ? Side::SELL : Side::BUY, size_));
+}
+
+//------------ Liquidity taker ----------------
+
+LiquidityTakerAgent::LiquidityTakerAgent(double order_prob, int min_size, int max_size, uint64_t seed)
+    : order_prob_(order_prob), min_size_(min_size), max_size_(max_size), rng_(seed) {
+    if (min_size <= 0 || max_size < min_size) {
+        throw std::invalid_argument("Size range must be positive and ordered");
+    }
+}
+
+void LiquidityTakerAgent::onStep(const MarketView& market, OrderSink& orders) {
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(rng_) > order_prob_) {
+        return;
+    }
+
+    double half_spread = (market.bestAsk() - market.bestBid()) / 2;
+    int size = std::uniform_int_distribution<int>(min_size_, max_size_)(rng_);
+    double total_cost = market.fee_per_share + market.fee_per_order / size;
+    if (half_spread < total_cost) {
+        return;
+    }
+
+    Side side = std::uniform_int_distribution<int>(0, 1)(rng_) == 0 ? Side::BUY : Side::SELL;
+    orders.submitOrder(marketOrder(orders, market.symbol, side, size));
+}
+
+//------------ Populations ----------------
+
+std::vector<AgentKind> addAgentMix(Simulation& simulation, const AgentMix& mix, uint64_t seed) {
+    const std::vector<SymbolId>& symbols = simulation.getSymbolIds();
+    std::vector<AgentKind> kinds;
+    auto add = [&](AgentKind kind, const char* tag, size_t index, std::shared_ptr<Agent> agent) {
+        SymbolId symbol = symbols[simulation.agentCount() % symbols.size()];
+        simulation.addAgent(std::string(tag) + "-" + std::to_string(index), symbol, std::move(agent));
+        kinds.push_back(kind);
+    };
+    for (size_t i = 0; i < mix.market_makers; i++) {
+        add(AgentKind::MARKET_MAKER, "MM", i,
+            std::make_shared<MarketMakerAgent>(mix.market_maker_spread, mix.market_maker_size));
+    }
+    for (size_t i = 0; i < mix.trend_followers; i++) {
+        add(AgentKind::TREND_FOLLOWER, "TF", i, std::make_shared<TrendFollowerAgent>());
+    }
+    for (size_t i = 0; i < mix.mean_reverters; i++) {
+        add(AgentKind::MEAN_REVERTER, "MR", i, std::make_shared<MeanReverterAgent>());
+    }
+    for (size_t i = 0; i < mix.liquidity_takers; i++) {
+        add(AgentKind::LIQUIDITY_TAKER, "LT", i, std::make_shared<LiquidityTakerAgent>(
+            mix.liquidity_taker_prob, 1, 5, deriveSeed(seed, simulation.agentCount())));
+    }
+    return kinds;
+}
+
+uint64_t deriveSeed(uint64_t seed, uint64_t stream) {
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
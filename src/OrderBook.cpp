@@ -1,310 +1,797 @@
 #include "OrderBook.hpp"
+#include "EngineStats.hpp"
 #include <algorithm>
-#include <random>
-#include <sstream>
-#include <iomanip>
+#include <atomic>
+#include <cmath>
+#include <limits>
 
-OrderBook::OrderBook(const std::string& symbol)
-    : symbol_(symbol) {}
+OrderBook::OrderBook(SymbolId symbol, const std::string& name, double tick_size)
+    : symbol_(symbol),
+      name_(name),
+      trade_sequence_(0),
+      tick_size_(tick_size),
+      clock_(nullptr),
+      mode_(MatchingMode::BATCH),
+      bids_(Side::BUY),
+      asks_(Side::SELL),
+      branch_depth_(0),
+      trade_sink_(nullptr),
+      market_data_(nullptr),
+      market_data_sequence_(0),
+      market_data_time_(0),
+      published_top_{PriceLadder::NO_PRICE, 0, PriceLadder::NO_PRICE, 0} {
+    if (tick_size <= 0) {
+        throw std::runtime_error("Tick size must be positive");
+    }
+}
+
+//Storage is sized to what the source holds now rather than the defaults, so
+//copying a small book stays small
+OrderBook::OrderBook(const OrderBook& other)
+    : symbol_(other.symbol_),
+      name_(other.name_),
+      trade_sequence_(other.trade_sequence_),
+      tick_size_(other.tick_size_),
+      clock_(other.clock_),
+      mode_(other.mode_),
+      bids_(Side::BUY, 2 * other.bids_.occupiedSpan()),
+      asks_(Side::SELL, 2 * other.asks_.occupiedSpan()),
+      pool_(std::max<size_t>(64, other.bids_.orderCount() + other.asks_.orderCount())),
+      order_lookup_(2 * (other.bids_.orderCount() + other.asks_.orderCount())),
+      branch_depth_(0),
+      pending_trades_(other.pending_trades_),
+      trade_sink_(other.trade_sink_),
+      market_data_(other.market_data_),
+      market_data_sequence_(other.market_data_sequence_),
+      market_data_time_(other.market_data_time_),
+      published_top_(other.published_top_) {
+    copySide(other.bids_, bids_);
+    copySide(other.asks_, asks_);
+}
 
-void OrderBook::addOrder(const Order& order) {
+//Only the level headers are copied; queues, nodes and ids are read through base_
+OrderBook::OrderBook(std::shared_ptr<const OrderBook> base, size_t depth)
+    : symbol_(base->symbol_),
+      name_(base->name_),
+      trade_sequence_(base->trade_sequence_),
+      tick_size_(base->tick_size_),
+      clock_(base->clock_),
+      mode_(base->mode_),
+      bids_(Side::BUY, 2 * base->bids_.occupiedSpan()),
+      asks_(Side::SELL, 2 * base->asks_.occupiedSpan()),
+      pool_(64),
+      order_lookup_(64),
+      branch_depth_(depth),
+      pending_trades_(base->pending_trades_),
+      trade_sink_(base->trade_sink_),
+      market_data_(base->market_data_),
+      market_data_sequence_(base->market_data_sequence_),
+      market_data_time_(base->market_data_time_),
+      published_top_(base->published_top_) {
+    shareSide(base->bids_, bids_);
+    shareSide(base->asks_, asks_);
+    base_ = std::move(base);
+}
+
+std::shared_ptr<OrderBook> OrderBook::branch(std::shared_ptr<const OrderBook> base) {
+    if (base->branch_depth_ >= MAX_BRANCH_DEPTH) {
+        return std::make_shared<OrderBook>(*base); //Keeps lookups from walking a long chain
+    }
+    size_t depth = base->branch_depth_ + 1;
+    return std::shared_ptr<OrderBook>(new OrderBook(std::move(base), depth));
+}
+
+//Throwing wrapper kept for callers that treat an unfilled market order as an error
+void OrderBook::addOrder(const Order& order, uint64_t now) {
     if (order.symbol != symbol_) {
         throw std::runtime_error("Order symbol does not match orderbook symbol");
     }
 
-    if (order.isMarket()) {
-        processMarketOrder(order); // Immediately process market orders
-    } else {
-        addOrderToBook(order); //Limit orders go to book
+    bool had_liquidity = !(order.isBuy() ? asks_ : bids_).empty();
+    SubmitResult result = submitOrder(order, now);
+
+    if (result.status == SubmitStatus::REJECTED) {
+        throw std::runtime_error("Price is outside the supported ladder range");
+    }
+    if (order.isMarket() && result.remaining > 0) {
+        if (!had_liquidity) {
+            throw std::runtime_error(order.isBuy()
+                ? "No liquidity available for market buy order"
+                : "No liquidity available for market sell order");
+        }
+        throw std::runtime_error("Insufficient liquidity for market order");
     }
 }
 
-void OrderBook::processMarketOrder(const Order& order) {
+SubmitResult OrderBook::submitOrder(const Order& order, uint64_t now) {
+    ORDERBOOK_STATS_TIMER(order.isLimit() ? StatsOp::ADD : StatsOp::MARKET);
+    if (order.symbol != symbol_) {
+        ORDERBOOK_STATS_COUNT(StatsCounter::REJECTS, 1);
+        return {SubmitStatus::REJECTED, 0, order.quantity};
+    }
+
     Order working_order = order;
-    
-    if (working_order.isBuy()) { // Market buy orders match against asks
-        if (asks_.empty()) {
-            throw std::runtime_error("No liquidity available for market buy order");
+    working_order.timestamp = now; //One clock read covers the order and its fills
+    market_data_time_ = working_order.timestamp;
+    PriceLadder& own_side = working_order.isBuy() ? bids_ : asks_;
+    PriceLadder& book_side = working_order.isBuy() ? asks_ : bids_; // Buys match against asks, sells against bids
+
+    //Work out how far through the opposite side this order may trade
+    Price limit = PriceLadder::NO_PRICE;
+    if (working_order.isLimit()) {
+        limit = toTicks(working_order);
+        if (limit == PriceLadder::NO_PRICE
+            || (working_order.tif == TimeInForce::GTC && !own_side.canHold(limit))) {
+            ORDERBOOK_STATS_COUNT(StatsCounter::REJECTS, 1);
+            return {SubmitStatus::REJECTED, 0, order.quantity};
         }
-        while (!asks_.empty() && working_order.quantity > 0) {
-            auto best_ask = asks_.begin();
-            auto& ask_orders = best_ask->second;
-            
-            while (!ask_orders.empty() && working_order.quantity > 0) {
-                Order& ask = ask_orders.front();
-                int trade_quantity = std::min(working_order.quantity, ask.quantity);
-                double trade_price = ask.price;
-                
+    }
+    ORDERBOOK_STATS_COUNT(StatsCounter::ORDERS, 1); //Accepted from here on, even if nothing trades or rests
+    if (!working_order.isLimit()) {
+        if (book_side.empty()) {
+            return {SubmitStatus::CANCELLED, 0, order.quantity};
+        }
+        limit = working_order.isMarketToLimit()
+            ? book_side.best() //Trades at the touch only, remainder rests there
+            : (working_order.isBuy() ? std::numeric_limits<Price>::max() : std::numeric_limits<Price>::min());
+    }
 
-                Trade trade(
-                    generateTradeId(),
-                    symbol_,
-                    trade_price,
-                    trade_quantity,
-                    working_order.order_id,
-                    ask.order_id
-                ); // Initialize trade
-                pending_trades_.push_back(trade);
-                
-                working_order.quantity -= trade_quantity;
-                ask.quantity -= trade_quantity;
-                
-                if (ask.quantity == 0) {
-                    order_lookup_.erase(ask.order_id);
-                    ask_orders.pop_front();
-                } // Remove executed orders
-            }
-            
-            //Clean up
-            if (ask_orders.empty()) {
-                asks_.erase(best_ask);
-            }
+    if (working_order.tif == TimeInForce::FOK
+        && availableQuantity(book_side, working_order.side, limit, working_order.quantity) < working_order.quantity) {
+        return {SubmitStatus::CANCELLED, 0, order.quantity};
+    }
+
+    //In batch mode GTC limits wait for the next matchOrders() pass; everything else trades on arrival
+    if (mode_ == MatchingMode::CONTINUOUS || !working_order.isLimit() || working_order.tif != TimeInForce::GTC) {
+        matchIncoming(working_order, book_side, limit);
+    }
+
+    int filled = order.quantity - working_order.quantity;
+    if (working_order.quantity == 0) {
+        if (market_data_) publishTop();
+        return {SubmitStatus::FILLED, filled, 0};
+    }
+
+    bool rests = !working_order.isMarket() && working_order.tif == TimeInForce::GTC;
+    if (rests && working_order.isMarketToLimit() && !own_side.canHold(limit)) {
+        rests = false; //No room at the touch it traded at: cancel the remainder rather than throw after filling
+    }
+    if (!rests) {
+        if (market_data_) publishTop();
+        return {filled > 0 ? SubmitStatus::PARTIALLY_CANCELLED : SubmitStatus::CANCELLED,
+                filled, working_order.quantity};
+    }
+
+    if (working_order.isMarketToLimit()) {
+        working_order.type = OrderType::LIMIT; //From here on it is a plain limit order
+        working_order.price = toPrice(limit);
+    }
+    addOrderToBook(working_order);
+    if (market_data_) publishTop();
+    return {filled > 0 ? SubmitStatus::PARTIALLY_FILLED : SubmitStatus::RESTING,
+            filled, working_order.quantity};
+}
+
+//Sweep the opposite side from the touch while it is within limit (in ticks).
+//Trades execute at the resting price; the incoming quantity is reduced in place.
+void OrderBook::matchIncoming(Order& working_order, PriceLadder& book_side, Price limit) {
+    while (!book_side.empty() && working_order.quantity > 0) {
+        Price best_price = book_side.best();
+        if (working_order.isBuy() ? best_price > limit : best_price < limit) {
+            break;
         }
-    } else {
-        if (bids_.empty()) {
-            throw std::runtime_error("No liquidity available for market sell order"); // For market sell orders -> match against bids
+        PriceLevel& resting_orders = *book_side.find(best_price);
+        if (resting_orders.shared) copySharedLevel(book_side, best_price);
+
+        while (!resting_orders.empty() && working_order.quantity > 0) {
+            OrderNode* resting_node = resting_orders.front();
+            Order& resting = resting_node->order;
+            int trade_quantity = std::min(working_order.quantity, resting.quantity);
+
+            Trade trade(
+                nextTradeId(),
+                symbol_,
+                toPrice(best_price),
+                trade_quantity,
+                working_order.isBuy() ? working_order.order_id : resting.order_id,
+                working_order.isBuy() ? resting.order_id : working_order.order_id,
+                working_order.timestamp,
+                working_order.isBuy() ? working_order.client_id : resting.client_id,
+                working_order.isBuy() ? resting.client_id : working_order.client_id
+            ); // Initialize trade
+            addTrade(trade);
+            ORDERBOOK_STATS_COUNT(StatsCounter::TRADES, 1);
+            if (market_data_) publishTrade(trade, working_order.side);
+
+            working_order.quantity -= trade_quantity;
+            resting_orders.fill(resting_node, trade_quantity);
+            book_side.adjustTotals(-trade_quantity, 0);
+
+            if (resting.quantity == 0) {
+                resting_orders.popFront();
+                book_side.adjustTotals(0, -1);
+                releaseNode(resting_node);
+            } // Remove executed orders
         }
-        // Same methodology as above...
-        while (!bids_.empty() && working_order.quantity > 0) {
-            auto best_bid = bids_.begin();
-            auto& bid_orders = best_bid->second;
-            
-            while (!bid_orders.empty() && working_order.quantity > 0) {
-                Order& bid = bid_orders.front();
-                int trade_quantity = std::min(working_order.quantity, bid.quantity);
-                double trade_price = bid.price;
-                
-                Trade trade(
-                    generateTradeId(),
-                    symbol_,
-                    trade_price,
-                    trade_quantity,
-                    bid.order_id,
-                    working_order.order_id
-                );
-                pending_trades_.push_back(trade);
-                
-                working_order.quantity -= trade_quantity;
-                bid.quantity -= trade_quantity;
-                
-                if (bid.quantity == 0) {
-                    order_lookup_.erase(bid.order_id);
-                    bid_orders.pop_front();
-                }
-            }
-            
-            // Clean up empty price levels
-            if (bid_orders.empty()) {
-                bids_.erase(best_bid);
-            }
+
+        //Clean up
+        if (resting_orders.empty()) {
+            book_side.release(best_price);
         }
+        if (market_data_) publishLevel(book_side, best_price, false);
     }
-    
-    //If there's remaining quantity, reject order:
-    if (working_order.quantity > 0) {
-        throw std::runtime_error("Insufficient liquidity for market order");
+}
+
+//Quantity on book_side that an incoming order on `side` could take within limit.
+//Walks levels using their cached totals and stops as soon as `needed` is covered.
+int64_t OrderBook::availableQuantity(const PriceLadder& book_side, Side side, Price limit, int64_t needed) const {
+    int64_t available = 0;
+    for (Price price = book_side.best(); price != PriceLadder::NO_PRICE; price = book_side.next(price)) {
+        if (side == Side::BUY ? price > limit : price < limit) break;
+        available += book_side.find(price)->total_quantity;
+        if (available >= needed) break;
     }
+    return available;
 }
 
-void OrderBook::cancelOrder(const std::string& order_id) {
-    if (!hasOrder(order_id)) {
+void OrderBook::cancelOrder(OrderId order_id) {
+    if (!tryCancelOrder(order_id)) {
         throw std::runtime_error("Order not found");
     }
+}
+
+//Cancelling an order that already traded or expired is routine, so this reports it instead of throwing
+bool OrderBook::tryCancelOrder(OrderId order_id) {
+    ORDERBOOK_STATS_TIMER(StatsOp::CANCEL);
+    if (!hasOrder(order_id)) {
+        return false;
+    }
+    if (market_data_) market_data_time_ = currentTime();
     removeOrderFromBook(order_id);
+    if (market_data_) publishTop();
+    return true;
 }
 
-std::vector<Trade> OrderBook::matchOrders() { //Process all orders in the book
-    std::vector<Trade> all_trades = std::move(pending_trades_);
-    pending_trades_.clear();
-    
+std::vector<Trade> OrderBook::matchOrders(uint64_t now) { //Process all orders in the book
+    ORDERBOOK_STATS_TIMER(StatsOp::MATCH);
+    uncross(now);
+    if (market_data_) publishTop();
+    return pending_trades_.take();
+}
+
+void OrderBook::setMatchingMode(MatchingMode mode) {
+    if (mode == MatchingMode::CONTINUOUS && mode_ == MatchingMode::BATCH) {
+        uncross(currentTime()); //Continuous matching assumes a book that is not crossed
+        if (market_data_) publishTop();
+    }
+    mode_ = mode;
+}
+
+bool OrderBook::needsMatching() const {
+    bool crossed = mode_ == MatchingMode::BATCH && !bids_.empty() && !asks_.empty() && bids_.best() >= asks_.best();
+    return crossed || !pending_trades_.empty();
+}
+
+//Batch crossing pass: trade while the best bid is at or above the best ask
+void OrderBook::uncross(uint64_t now) {
+    market_data_time_ = now;
     while (!bids_.empty() && !asks_.empty()) {
-        auto best_bid = bids_.begin();
-        auto best_ask = asks_.begin();
+        Price bid_price = bids_.best();
+        Price ask_price = asks_.best();
         
-        if (best_bid->first >= best_ask->first) {
+        if (bid_price >= ask_price) {
             // We have a match!
-            auto& bid_orders = best_bid->second;
-            auto& ask_orders = best_ask->second;
+            PriceLevel& bid_orders = *bids_.find(bid_price);
+            PriceLevel& ask_orders = *asks_.find(ask_price);
+            if (bid_orders.shared) copySharedLevel(bids_, bid_price);
+            if (ask_orders.shared) copySharedLevel(asks_, ask_price);
             
             while (!bid_orders.empty() && !ask_orders.empty()) {
-                Order& bid = bid_orders.front();
-                Order& ask = ask_orders.front();
+                OrderNode* bid_node = bid_orders.front();
+                OrderNode* ask_node = ask_orders.front();
+                Order& bid = bid_node->order;
+                Order& ask = ask_node->order;
                 
                 int trade_quantity = std::min(bid.quantity, ask.quantity);
-                double trade_price = ask.price; //Use ask price as execution price
+                double trade_price = toPrice(ask_price); //Use ask price as execution price
                 
                 Trade trade(
-                    generateTradeId(),
+                    nextTradeId(),
                     symbol_,
                     trade_price,
                     trade_quantity,
                     bid.order_id,
-                    ask.order_id
-                ); // initialize and add trade to all_trades
-                all_trades.push_back(trade);
+                    ask.order_id,
+                    now,
+                    bid.client_id,
+                    ask.client_id
+                ); // initialize and hand trade to the sink
+                addTrade(trade);
+                ORDERBOOK_STATS_COUNT(StatsCounter::TRADES, 1);
+                if (market_data_) publishTrade(trade, Side::BUY); //The bid lifts the ask
                 
                 //Updates
-                bid.quantity -= trade_quantity;
-                ask.quantity -= trade_quantity;
+                bid_orders.fill(bid_node, trade_quantity);
+                ask_orders.fill(ask_node, trade_quantity);
+                bids_.adjustTotals(-trade_quantity, 0);
+                asks_.adjustTotals(-trade_quantity, 0);
                 
                 //Remove fully executed orders
                 if (bid.quantity == 0) {
-                    order_lookup_.erase(bid.order_id);
-                    bid_orders.pop_front();
+                    bid_orders.popFront();
+                    bids_.adjustTotals(0, -1);
+                    releaseNode(bid_node);
                 }
                 if (ask.quantity == 0) {
-                    order_lookup_.erase(ask.order_id);
-                    ask_orders.pop_front();
+                    ask_orders.popFront();
+                    asks_.adjustTotals(0, -1);
+                    releaseNode(ask_node);
                 }
             }
             
             //Clean up
             if (bid_orders.empty()) {
-                bids_.erase(best_bid);
+                bids_.release(bid_price);
             }
             if (ask_orders.empty()) {
-                asks_.erase(best_ask);
+                asks_.release(ask_price);
+            }
+            if (market_data_) {
+                publishLevel(bids_, bid_price, false);
+                publishLevel(asks_, ask_price, false);
             }
         } else {
             break; //All fully matched up, nothing else left
         }
     }
-    
-    return all_trades;
 }
 
 //------------ Helper methods ----------------
 
 double OrderBook::getBestBid() const {
-    return bids_.empty() ? 0.0 : bids_.begin()->first;
+    return bids_.empty() ? 0.0 : toPrice(bids_.best());
 }
 
 double OrderBook::getBestAsk() const {
-    return asks_.empty() ? 0.0 : asks_.begin()->first;
+    return asks_.empty() ? 0.0 : toPrice(asks_.best());
 }
 
 int OrderBook::getBidSize() const {
-    int total = 0;
-    for (const auto& [price, orders] : bids_) {
-        for (const auto& order : orders) {
-            total += order.quantity;
-        }
-    }
-    return total;
+    return static_cast<int>(bids_.totalQuantity());
 }
 
 int OrderBook::getAskSize() const {
-    int total = 0;
-    for (const auto& [price, orders] : asks_) {
-        for (const auto& order : orders) {
-            total += order.quantity;
-        }
-    }
-    return total;
+    return static_cast<int>(asks_.totalQuantity());
+}
+
+int OrderBook::getBidOrderCount() const {
+    return static_cast<int>(bids_.orderCount());
+}
+
+int OrderBook::getAskOrderCount() const {
+    return static_cast<int>(asks_.orderCount());
 }
 
 std::vector<std::pair<double, int>> OrderBook::getBidDepth(int levels) const {
+    return getDepth(bids_, levels);
+}
+
+std::vector<std::pair<double, int>> OrderBook::getAskDepth(int levels) const {
+    return getDepth(asks_, levels);
+}
+
+std::vector<std::pair<double, int>> OrderBook::getDepth(const PriceLadder& ladder, int levels) const {
     std::vector<std::pair<double, int>> depth;
+    depth.reserve(std::min<size_t>(ladder.levelCount(), levels > 0 ? levels : 0));
     int count = 0;
     
-    for (const auto& [price, orders] : bids_) {
+    for (Price price = ladder.best(); price != PriceLadder::NO_PRICE; price = ladder.next(price)) {
         if (count >= levels) break;
         
-        int total_quantity = 0;
-        for (const auto& order : orders) {
-            total_quantity += order.quantity;
-        }
-        
-        depth.emplace_back(price, total_quantity);
+        const PriceLevel& level = *ladder.find(price);
+        depth.emplace_back(toPrice(price), static_cast<int>(level.total_quantity));
         count++;
     }
     
     return depth;
 }
 
-std::vector<std::pair<double, int>> OrderBook::getAskDepth(int levels) const {
-    std::vector<std::pair<double, int>> depth;
+int OrderBook::copyDepth(const PriceLadder& ladder, int levels, double* prices, int* quantities) const {
     int count = 0;
-    
-    for (const auto& [price, orders] : asks_) {
-        if (count >= levels) break;
-        
-        int total_quantity = 0;
-        for (const auto& order : orders) {
-            total_quantity += order.quantity;
-        }
-        
-        depth.emplace_back(price, total_quantity);
+    for (Price price = ladder.best(); price != PriceLadder::NO_PRICE && count < levels; price = ladder.next(price)) {
+        prices[count] = toPrice(price);
+        quantities[count] = static_cast<int>(ladder.find(price)->total_quantity);
         count++;
     }
-    
-    return depth;
+    return count;
 }
 
-bool OrderBook::hasOrder(const std::string& order_id) const {
-    return order_lookup_.find(order_id) != order_lookup_.end();
+bool OrderBook::hasOrder(OrderId order_id) const {
+    return findNode(order_id) != nullptr;
 }
 
-const Order* OrderBook::getOrder(const std::string& order_id) const {
-    auto it = order_lookup_.find(order_id);
-    if (it == order_lookup_.end()) {
-        return nullptr;
-    }
-    return &(*it->second.second);
+const Order* OrderBook::getOrder(OrderId order_id) const {
+    const OrderNode* node = findNode(order_id);
+    return node ? &node->order : nullptr;
+}
+
+OrderBook::AllocationStats OrderBook::getAllocationStats() const {
+    AllocationStats stats;
+    stats.pool = pool_.getStats();
+    stats.index_rehashes = order_lookup_.getRehashCount();
+    return stats;
 }
 
 void OrderBook::addOrderToBook(const Order& order) {
-    if (order.isBuy()) {
-        auto& price_level = bids_[order.price];
-        price_level.push_back(order);
-        order_lookup_[order.order_id] = std::make_pair(order.side, --price_level.end());
-    } else {
-        auto& price_level = asks_[order.price];
-        price_level.push_back(order);
-        order_lookup_[order.order_id] = std::make_pair(order.side, --price_level.end());
-    }
+    Price price = toTicks(order);
+    PriceLadder& ladder = order.isBuy() ? bids_ : asks_;
+    bool new_level = market_data_ && !ladder.find(price);
+    PriceLevel& price_level = ladder.getOrCreate(price);
+    if (price_level.shared) copySharedLevel(ladder, price);
+
+    OrderNode* node = pool_.acquire(order);
+    node->price = price;
+    node->order.price = toPrice(price); //Resting price is the tick-aligned one
+    price_level.pushBack(node);
+    ladder.adjustTotals(order.quantity, 1);
+    order_lookup_.insert(node);
+    ORDERBOOK_STATS_PEAK(bids_.orderCount() + asks_.orderCount());
+    if (market_data_) publishLevel(ladder, price, new_level);
 }
 
-void OrderBook::removeOrderFromBook(const std::string& order_id) {
-    auto it = order_lookup_.find(order_id);
-    if (it == order_lookup_.end()) {
+void OrderBook::removeOrderFromBook(OrderId order_id) {
+    OrderNode* node = findOwnNode(order_id);
+    if (!node) {
         throw std::runtime_error("Order not found");
     }
 
-    auto& [side, order_it] = it->second;
-    if (side == Side::BUY) {
-        auto price = order_it->price;
-        bids_[price].erase(order_it);
-        if (bids_[price].empty()) {
-            bids_.erase(price);
-        }
-    } else {
-        auto price = order_it->price;
-        asks_[price].erase(order_it);
-        if (asks_[price].empty()) {
-            asks_.erase(price);
-        }
+    PriceLadder& ladder = node->order.isBuy() ? bids_ : asks_;
+    PriceLevel* price_level = ladder.find(node->price);
+    price_level->remove(node);
+    ladder.adjustTotals(-node->order.quantity, -1);
+    if (price_level->empty()) {
+        ladder.release(node->price);
     }
-    order_lookup_.erase(it);
+    if (market_data_) publishLevel(ladder, node->price, false);
+    releaseNode(node);
 }
 
-std::string OrderBook::generateTradeId() const {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
-    static const char* hex_digits = "0123456789ABCDEF";
-    
-    std::stringstream ss;
-    ss << symbol_ << "-";
-    for (int i = 0; i < 8; ++i) {
-        ss << hex_digits[dis(gen)];
+//Drop a node that has already been unlinked from its level
+void OrderBook::releaseNode(OrderNode* node) {
+    order_lookup_.erase(node);
+    if (base_ && base_->findNode(node->order.order_id)) {
+        removed_.insert(node->order.order_id); //Hide the base's node for this id too
     }
-    return ss.str();
+    pool_.release(node);
+}
+
+//Limit prices off the tick grid are rounded conservatively:
+//buys down and sells up so an order never trades through its own limit.
+//The range check comes first: casting NaN, inf or a huge double to Price is undefined.
+Price OrderBook::toTicks(const Order& order) const {
+    constexpr double epsilon = 1e-9; //Absorbs binary rounding, e.g. 100.05 / 0.01
+    double ticks = order.price / tick_size_;
+    if (!(std::fabs(ticks) <= MAX_TICKS)) { //Also false for NaN
+        return PriceLadder::NO_PRICE;
+    }
+    return static_cast<Price>(order.isBuy() ? std::floor(ticks + epsilon)
+                                            : std::ceil(ticks - epsilon));
 }
 
 void OrderBook::clear() {
     bids_.clear();
     asks_.clear();
     order_lookup_.clear();
+    pool_.reset();
+    base_.reset();
+    removed_.clear();
+    branch_depth_ = 0;
     pending_trades_.clear();
-} 
\ No newline at end of file
+    if (market_data_) {
+        market_data_time_ = currentTime();
+        publishBook();
+    }
+}
+
+//------------ Market data ----------------
+
+void OrderBook::setMarketDataSink(MarketDataSink* sink) {
+    market_data_ = sink;
+    if (sink) {
+        market_data_time_ = currentTime();
+        publishBook();
+    }
+}
+
+//CLEAR, every level best first (bids then asks), then the top of book
+void OrderBook::publishBook() {
+    MarketDataUpdate update{};
+    update.event = MarketDataEvent::CLEAR;
+    publish(update);
+    for (const PriceLadder* ladder : {&bids_, &asks_}) {
+        for (Price price = ladder->best(); price != PriceLadder::NO_PRICE; price = ladder->next(price)) {
+            publishLevel(*ladder, price, true);
+        }
+    }
+    published_top_ = {PriceLadder::NO_PRICE, 0, PriceLadder::NO_PRICE, 0};
+    publishTop();
+}
+
+//The level at price as it is now: deleted if the ladder no longer holds it
+void OrderBook::publishLevel(const PriceLadder& ladder, Price price, bool created) {
+    const PriceLevel* level = ladder.find(price);
+    MarketDataUpdate update{};
+    update.event = !level ? MarketDataEvent::LEVEL_DELETE
+                 : created ? MarketDataEvent::LEVEL_ADD : MarketDataEvent::LEVEL_UPDATE;
+    update.side = ladder.getSide();
+    update.price = toPrice(price);
+    if (level) {
+        update.orders = level->order_count;
+        update.quantity = level->total_quantity;
+    }
+    publish(update);
+}
+
+void OrderBook::publishTrade(const Trade& trade, Side incoming_side) {
+    MarketDataUpdate update{};
+    update.event = MarketDataEvent::TRADE;
+    update.side = incoming_side;
+    update.price = trade.price;
+    update.quantity = trade.quantity;
+    update.trade_id = trade.trade_id;
+    publish(update);
+}
+
+//Sent only when a best price or its size differs from the last one published
+void OrderBook::publishTop() {
+    TopOfBook top{bids_.best(), 0, asks_.best(), 0};
+    if (top.bid != PriceLadder::NO_PRICE) top.bid_size = bids_.find(top.bid)->total_quantity;
+    if (top.ask != PriceLadder::NO_PRICE) top.ask_size = asks_.find(top.ask)->total_quantity;
+    if (top.bid == published_top_.bid && top.bid_size == published_top_.bid_size
+        && top.ask == published_top_.ask && top.ask_size == published_top_.ask_size) {
+        return;
+    }
+    published_top_ = top;
+
+    MarketDataUpdate update{};
+    update.event = MarketDataEvent::TOP_OF_BOOK;
+    update.price = top.bid == PriceLadder::NO_PRICE ? 0.0 : toPrice(top.bid);
+    update.quantity = top.bid_size;
+    update.ask_price = top.ask == PriceLadder::NO_PRICE ? 0.0 : toPrice(top.ask);
+    update.ask_quantity = top.ask_size;
+    publish(update);
+}
+
+void OrderBook::publish(MarketDataUpdate& update) {
+    update.sequence = ++market_data_sequence_;
+    update.timestamp = market_data_time_;
+    update.symbol = symbol_;
+    market_data_->onUpdate(update);
+}
+
+//------------ Copy-on-write branches ----------------
+
+//Own nodes first, then the base chain for orders this branch has not touched
+const OrderNode* OrderBook::findNode(OrderId order_id) const {
+    const OrderNode* node = order_lookup_.find(order_id);
+    if (node || !base_ || removed_.count(order_id)) {
+        return node;
+    }
+    return base_->findNode(order_id);
+}
+
+OrderNode* OrderBook::findOwnNode(OrderId order_id) {
+    OrderNode* node = order_lookup_.find(order_id);
+    if (node || !base_) {
+        return node;
+    }
+    const OrderNode* shared = findNode(order_id);
+    if (!shared) {
+        return nullptr;
+    }
+    PriceLadder& ladder = shared->order.isBuy() ? bids_ : asks_;
+    const PriceLevel* level = ladder.find(shared->price);
+    if (!level || !level->shared) {
+        return nullptr; //Not linked into this book (a duplicate id it already replaced)
+    }
+    copySharedLevel(ladder, shared->price);
+    return order_lookup_.find(order_id);
+}
+
+//Moves a shared level's queue into this book's own nodes so it can change. Totals
+//are unchanged; the copies take over the ids the base's nodes were indexed under.
+void OrderBook::copySharedLevel(PriceLadder& ladder, Price price) {
+    PriceLevel& level = *ladder.find(price);
+    const OrderNode* node = level.front();
+    level = PriceLevel{};
+    for (; node; node = node->next) {
+        bool indexed = findNode(node->order.order_id) == node;
+        OrderNode* copy = pool_.acquire(node->order);
+        copy->price = price;
+        level.pushBack(copy);
+        if (indexed) {
+            order_lookup_.insert(copy);
+        }
+    }
+}
+
+//Level headers only: each queue stays in the source's nodes, marked shared
+void OrderBook::shareSide(const PriceLadder& source, PriceLadder& ladder) {
+    for (Price price = source.best(); price != PriceLadder::NO_PRICE; price = source.next(price)) {
+        const PriceLevel& source_level = *source.find(price);
+        PriceLevel& level = ladder.getOrCreate(price);
+        level = source_level;
+        level.shared = true;
+        ladder.adjustTotals(source_level.total_quantity, source_level.order_count);
+    }
+}
+
+//Folds base_ into this book for as long as this book holds the only reference to it:
+//the base's nodes for levels this book copied go back to the base's pool, the rest
+//become this book's, and the base's index (with this book's nodes put in) replaces ours
+void OrderBook::absorbBases() {
+    while (base_ && base_.use_count() == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire); //Pairs with the release when another owner let go
+        OrderBook& base = const_cast<OrderBook&>(*base_); //Created non-const in branch(), now ours alone
+        OrderIndex& index = base.order_lookup_;
+        auto replaced = [this](const OrderNode* node) { //Its level here is no longer the base's queue
+            const PriceLevel* level = (node->order.isBuy() ? bids_ : asks_).find(node->price);
+            return !level || !level->shared;
+        };
+
+        std::unordered_set<OrderId> removed;
+        for (OrderId order_id : removed_) {
+            if (OrderNode* old = index.find(order_id)) {
+                index.erase(old);
+                if (replaced(old)) base.pool_.release(old);
+            }
+            if (base.base_ && base.base_->findNode(order_id)) {
+                removed.insert(order_id); //Still rests further down the chain
+            }
+        }
+        order_lookup_.forEach([&](OrderNode* node) {
+            OrderNode* old = index.find(node->order.order_id);
+            if (old && replaced(old)) base.pool_.release(old);
+            index.insert(node);
+        });
+        removed.insert(base.removed_.begin(), base.removed_.end());
+
+        //Levels shared with the base now hold nodes this book owns, unless the base shared them too
+        for (PriceLadder* ladder : {&bids_, &asks_}) {
+            const PriceLadder& base_ladder = ladder == &bids_ ? base.bids_ : base.asks_;
+            for (Price price = ladder->best(); price != PriceLadder::NO_PRICE; price = ladder->next(price)) {
+                PriceLevel& level = *ladder->find(price);
+                if (level.shared) level.shared = base_ladder.find(price)->shared;
+            }
+        }
+
+        pool_.adopt(base.pool_);
+        order_lookup_ = std::move(index);
+        removed_ = std::move(removed);
+        branch_depth_ = base.branch_depth_;
+        std::shared_ptr<const OrderBook> next = std::move(base.base_);
+        base_ = std::move(next);
+    }
+}
+
+//------------ State images ----------------
+
+namespace {
+
+//One resting order in an image; side, price, type and tif come from its level
+struct RestingOrderImage {
+    OrderId order_id;
+    uint64_t timestamp;
+    ClientId client_id;
+    int32_t quantity;
+};
+static_assert(sizeof(RestingOrderImage) == 24, "Resting order images are fixed-size");
+
+} // namespace
+
+void OrderBook::saveState(ImageWriter& image) const {
+    image.put(trade_sequence_);
+    image.put(mode_);
+    image.put(static_cast<uint64_t>(bids_.orderCount() + asks_.orderCount()));
+    saveSide(bids_, image);
+    saveSide(asks_, image);
+}
+
+void OrderBook::saveSide(const PriceLadder& ladder, ImageWriter& image) {
+    image.put(static_cast<uint64_t>(ladder.levelCount()));
+    for (Price price = ladder.best(); price != PriceLadder::NO_PRICE; price = ladder.next(price)) {
+        const PriceLevel& level = *ladder.find(price);
+        image.put(price);
+        image.put(static_cast<uint32_t>(level.order_count));
+        for (const OrderNode* node = level.front(); node; node = node->next) {
+            image.put(RestingOrderImage{node->order.order_id, node->order.timestamp,
+                                        node->order.client_id, node->order.quantity});
+        }
+    }
+}
+
+void OrderBook::loadState(ImageReader& image) {
+    if (!bids_.empty() || !asks_.empty()) {
+        throw std::runtime_error("Book state can only be loaded into an empty book");
+    }
+    base_.reset(); //An empty branch takes nothing from its base
+    removed_.clear();
+    branch_depth_ = 0;
+    trade_sequence_ = image.get<uint64_t>();
+    mode_ = image.get<MatchingMode>();
+    if (mode_ != MatchingMode::BATCH && mode_ != MatchingMode::CONTINUOUS) {
+        throw std::runtime_error("Book state has an unknown matching mode in " + name_);
+    }
+    order_lookup_.reserve(image.get<uint64_t>());
+    loadSide(bids_, image);
+    loadSide(asks_, image);
+    if (market_data_) {
+        market_data_time_ = currentTime();
+        publishBook();
+    }
+}
+
+//Levels arrive best first with their queues in order, so each one is appended
+//to the ladder whole: no matching, no per-order level lookups
+void OrderBook::loadSide(PriceLadder& ladder, ImageReader& image) {
+    Side side = ladder.getSide();
+    uint64_t level_count = image.get<uint64_t>();
+    Price previous = PriceLadder::NO_PRICE;
+
+    for (uint64_t i = 0; i < level_count; i++) {
+        Price price = image.get<Price>();
+        uint32_t order_count = image.get<uint32_t>();
+        bool in_order = previous == PriceLadder::NO_PRICE
+                        || (side == Side::BUY ? price < previous : price > previous);
+        if (!in_order || order_count == 0 || !ladder.canHold(price)) {
+            throw std::runtime_error("Book state has an invalid price level in " + name_);
+        }
+        previous = price;
+
+        PriceLevel& level = ladder.getOrCreate(price);
+        int64_t level_quantity = 0;
+        for (uint32_t j = 0; j < order_count; j++) {
+            RestingOrderImage resting = image.get<RestingOrderImage>();
+            if (resting.quantity <= 0) {
+                throw std::runtime_error("Book state has a non-positive order quantity in " + name_);
+            }
+            Order order;
+            order.order_id = resting.order_id;
+            order.client_id = resting.client_id;
+            order.symbol = symbol_;
+            order.price = toPrice(price);
+            order.quantity = resting.quantity;
+            order.side = side;
+            order.type = OrderType::LIMIT;
+            order.tif = TimeInForce::GTC;
+            order.timestamp = resting.timestamp;
+
+            if (!appendResting(level, price, order)) {
+                throw std::runtime_error("Book state repeats order id " + std::to_string(order.order_id) + " in " + name_);
+            }
+            level_quantity += resting.quantity;
+        }
+        ladder.adjustTotals(level_quantity, static_cast<int>(order_count));
+    }
+}
+
+void OrderBook::copySide(const PriceLadder& source, PriceLadder& ladder) {
+    for (Price price = source.best(); price != PriceLadder::NO_PRICE; price = source.next(price)) {
+        const PriceLevel& source_level = *source.find(price);
+        PriceLevel& level = ladder.getOrCreate(price);
+        for (const OrderNode* node = source_level.front(); node; node = node->next) {
+            appendResting(level, price, node->order);
+        }
+        ladder.adjustTotals(source_level.total_quantity, source_level.order_count);
+    }
+}
+
+//Queues a resting order at the back of its level; the caller keeps the ladder totals
+bool OrderBook::appendResting(PriceLevel& level, Price price, const Order& order) {
+    OrderNode* node = pool_.acquire(order);
+    node->price = price;
+    level.pushBack(node);
+    size_t indexed = order_lookup_.size();
+    order_lookup_.insert(node);
+    return order_lookup_.size() != indexed;
+}
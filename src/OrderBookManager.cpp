@@ -1,124 +1,615 @@
 #include "OrderBookManager.hpp"
+#include "EngineStats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <stdexcept>
 
 //----------- Essentially a wrapper to help manage multiple orderbooks ---------
 //----------- Most functions just call their relevant symbol's orderbook -------
 
-void OrderBookManager::addOrderBook(const std::string& symbol) {
+OrderBookManager::OrderBookManager()
+    : clock_(std::make_unique<SteadyClock>()),
+      trade_sink_(nullptr),
+      market_data_sink_(nullptr),
+      partition_(Partition::STATIC),
+      symbols_(std::make_shared<IdInterner<SymbolId>>()),
+      order_ids_(std::make_shared<IdInterner<OrderId>>(INTERNED_ORDER_ID_BASE)),
+      client_ids_(std::make_shared<IdInterner<ClientId>>(INTERNED_CLIENT_ID_BASE)) {}
+
+void OrderBookManager::setClock(std::unique_ptr<Clock> clock) {
+    requireSync();
+    if (!clock) {
+        throw std::invalid_argument("Clock must not be null");
+    }
+    clock_ = std::move(clock);
+    for (auto& orderbook : orderbooks_) {
+        if (orderbook && orderbook.use_count() == 1) orderbook->setClock(clock_.get()); //Shared ones on copy
+    }
+}
+
+std::unique_ptr<OrderBookManager> OrderBookManager::fork() const {
+    requireSync();
+    auto branch = std::make_unique<OrderBookManager>();
+    branch->clock_ = clock_->clone();
+    branch->partition_ = partition_;
+    branch->orderbooks_ = orderbooks_;
+    branch->symbols_ = symbols_;
+    branch->order_ids_ = order_ids_;
+    branch->client_ids_ = client_ids_;
+    return branch;
+}
+
+void OrderBookManager::setJournal(std::unique_ptr<JournalWriter> journal) {
+    requireSync();
+    journal_ = std::move(journal);
+    if (!journal_) {
+        return;
+    }
+    //Every symbol id handed out so far (so a replay assigns the same ids), each
+    //book's mode and its resting orders in queue order
+    for (SymbolId id = 1; id < orderbooks_.size(); id++) {
+        const auto& orderbook = orderbooks_[id];
+        journalEvent(JournalEvent::BOOK, id, 0, orderbook ? orderbook->getTickSize() : 0.01);
+        if (!orderbook) {
+            journalEvent(JournalEvent::REMOVE_BOOK, id);
+            continue;
+        }
+        journalEvent(JournalEvent::MODE, id, 0, 0.0, static_cast<int32_t>(orderbook->getMatchingMode()));
+        orderbook->forEachRestingOrder([this](const Order& order) {
+            journal_->appendOrder(order, order.timestamp);
+        });
+    }
+}
+
+//------------ State images ----------------
+
+static const char SNAPSHOT_MAGIC[8] = {'O', 'B', 'S', 'N', 'A', 'P', 0, 0};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+void OrderBookManager::saveSnapshot(std::vector<uint8_t>& image) const {
+    requireSync();
+    ImageWriter writer(image);
+    writer.putBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writer.put(SNAPSHOT_VERSION);
+
+    //Interning tables in id order, so loading hands out the same ids
+    writer.put(static_cast<uint64_t>(symbols_->size()));
+    for (size_t i = 0; i < symbols_->size(); i++) {
+        writer.putString(symbols_->name(static_cast<SymbolId>(symbols_->base() + i)));
+    }
+    writer.put(static_cast<uint64_t>(order_ids_->size()));
+    for (size_t i = 0; i < order_ids_->size(); i++) {
+        writer.putString(order_ids_->name(order_ids_->base() + i));
+    }
+    writer.put(static_cast<uint64_t>(client_ids_->size()));
+    for (size_t i = 0; i < client_ids_->size(); i++) {
+        writer.putString(client_ids_->name(static_cast<ClientId>(client_ids_->base() + i)));
+    }
+
+    uint64_t live_books = std::count_if(orderbooks_.begin(), orderbooks_.end(),
+                                        [](const auto& orderbook) { return orderbook != nullptr; });
+    writer.put(live_books);
+    for (const auto& orderbook : orderbooks_) {
+        if (!orderbook) continue;
+        writer.put(orderbook->getSymbol());
+        writer.put(orderbook->getTickSize());
+        orderbook->saveState(writer);
+    }
+}
+
+void OrderBookManager::loadSnapshot(const uint8_t* image, size_t size) {
+    requireSync();
+    if (journal_) {
+        throw std::runtime_error("Detach the journal before loading a snapshot");
+    }
+    ImageReader reader(image, size);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    for (char& c : magic) c = reader.get<char>();
+    if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not an order book snapshot");
+    }
+    uint32_t version = reader.get<uint32_t>();
+    if (version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(version));
+    }
+
+    //Built aside and swapped in, so a bad image leaves this manager untouched
+    IdInterner<SymbolId> symbols;
+    IdInterner<OrderId> order_ids(INTERNED_ORDER_ID_BASE);
+    IdInterner<ClientId> client_ids(INTERNED_CLIENT_ID_BASE);
+    for (uint64_t i = 0, n = reader.get<uint64_t>(); i < n; i++) symbols.intern(reader.getString());
+    for (uint64_t i = 0, n = reader.get<uint64_t>(); i < n; i++) order_ids.intern(reader.getString());
+    for (uint64_t i = 0, n = reader.get<uint64_t>(); i < n; i++) client_ids.intern(reader.getString());
+
+    std::vector<std::shared_ptr<OrderBook>> orderbooks(symbols.size() + symbols.base());
+    for (uint64_t i = 0, n = reader.get<uint64_t>(); i < n; i++) {
+        SymbolId id = reader.get<SymbolId>();
+        double tick_size = reader.get<double>();
+        if (!symbols.contains(id) || orderbooks[id]) {
+            throw std::runtime_error("Snapshot has an unknown or repeated symbol id " + std::to_string(id));
+        }
+        auto orderbook = std::make_shared<OrderBook>(id, symbols.name(id), tick_size);
+        orderbook->loadState(reader);
+        orderbook->setClock(clock_.get());
+        orderbook->setTradeSink(trade_sink_);
+        orderbook->setMarketDataSink(market_data_sink_);
+        orderbooks[id] = std::move(orderbook);
+    }
+    if (reader.remaining() != 0) {
+        throw std::runtime_error("Snapshot has trailing data");
+    }
+
+    symbols_ = std::make_shared<IdInterner<SymbolId>>(std::move(symbols));
+    order_ids_ = std::make_shared<IdInterner<OrderId>>(std::move(order_ids));
+    client_ids_ = std::make_shared<IdInterner<ClientId>>(std::move(client_ids));
+    orderbooks_ = std::move(orderbooks);
+    book_trades_.clear();
+    tape_.clear();
+}
+
+void OrderBookManager::saveSnapshot(const std::string& path) const {
+    std::vector<uint8_t> image;
+    saveSnapshot(image);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    if (!file) {
+        throw std::runtime_error("Cannot write snapshot: " + path);
+    }
+}
+
+void OrderBookManager::loadSnapshot(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Cannot open snapshot: " + path);
+    }
+    std::vector<uint8_t> image(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    if (!file) {
+        throw std::runtime_error("Cannot read snapshot: " + path);
+    }
+    loadSnapshot(image.data(), image.size());
+}
+
+void OrderBookManager::setSimulationTime(double seconds) {
+    auto* simulated = dynamic_cast<SimulatedClock*>(clock_.get());
+    if (!simulated) {
+        throw std::runtime_error("Simulation time requires a SimulatedClock");
+    }
+    simulated->setSeconds(seconds);
+}
+
+SymbolId OrderBookManager::addOrderBook(const std::string& symbol, double tick_size) {
+    requireSync();
     if (hasOrderBook(symbol)) {
         throw std::runtime_error("Orderbook already exists for symbol: " + symbol);
     }
-    orderbooks_[symbol] = std::make_unique<OrderBook>(symbol);
+    SymbolId id = unshare(symbols_).intern(symbol); //Re-adding a symbol reuses its id
+    if (orderbooks_.size() <= id) {
+        orderbooks_.resize(id + 1);
+    }
+    orderbooks_[id] = std::make_shared<OrderBook>(id, symbol, tick_size);
+    orderbooks_[id]->setClock(clock_.get());
+    orderbooks_[id]->setTradeSink(trade_sink_);
+    orderbooks_[id]->setMarketDataSink(market_data_sink_);
+    if (journal_) journalEvent(JournalEvent::BOOK, id, 0, tick_size);
+    return id;
 }
 
 bool OrderBookManager::hasOrderBook(const std::string& symbol) const {
-    return orderbooks_.find(symbol) != orderbooks_.end();
+    SymbolId id;
+    return symbols_->find(symbol, id) && getOrderBook(id) != nullptr;
 }
 
 void OrderBookManager::removeOrderBook(const std::string& symbol) {
+    requireSync();
     if (!hasOrderBook(symbol)) {
         throw std::runtime_error("Orderbook not found for symbol: " + symbol);
     }
-    orderbooks_.erase(symbol);
+    SymbolId id = getSymbolId(symbol);
+    orderbooks_[id].reset();
+    if (journal_) journalEvent(JournalEvent::REMOVE_BOOK, id);
 }
 
 void OrderBookManager::placeOrder(const Order& order) {
+    requireSync();
+    OrderBook& orderbook = requireOrderBook(order.symbol);
+    //Journalled before it can throw; a rejected order replays as the same rejection.
+    //One clock read stamps both, so the replay sees the order time the book used.
+    uint64_t now = clock_->now();
+    if (journal_) journal_->appendOrder(order, now);
+    orderbook.addOrder(order, now);
+}
+
+SubmitResult OrderBookManager::submitOrder(const Order& order) {
+    requireSync();
     auto* orderbook = getOrderBook(order.symbol);
     if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + order.symbol);
+        ORDERBOOK_STATS_COUNT(StatsCounter::REJECTS, 1);
+        return {SubmitStatus::REJECTED, 0, order.quantity};
+    }
+    uint64_t now = clock_->now(); //Journalled with the time the book stamped
+    SubmitResult result = orderbook->submitOrder(order, now);
+    if (journal_ && result.status != SubmitStatus::REJECTED) {
+        journal_->appendOrder(order, now);
     }
-    orderbook->addOrder(order);
+    return result;
 }
 
-void OrderBookManager::cancelOrder(const std::string& symbol, const std::string& order_id) {
-    auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + symbol);
+void OrderBookManager::submitOrders(const Order* orders, size_t count, SubmitResult* results) {
+    requireSync();
+    for (size_t i = 0; i < count; i++) {
+        const Order& order = orders[i];
+        auto* orderbook = getOrderBook(order.symbol);
+        if (!orderbook || Order::validate(order.type, order.price, order.quantity)) {
+            ORDERBOOK_STATS_COUNT(StatsCounter::REJECTS, 1);
+            results[i] = {SubmitStatus::REJECTED, 0, order.quantity};
+        } else {
+            uint64_t now = clock_->now();
+            results[i] = orderbook->submitOrder(order, now);
+            if (journal_ && results[i].status != SubmitStatus::REJECTED) {
+                journal_->appendOrder(order, now);
+            }
+        }
     }
-    orderbook->cancelOrder(order_id);
+}
+
+void OrderBookManager::tryCancelOrders(const SymbolId* symbols, const OrderId* order_ids, size_t count, bool* cancelled) {
+    requireSync();
+    for (size_t i = 0; i < count; i++) {
+        auto* orderbook = getOrderBook(symbols[i]);
+        cancelled[i] = orderbook && orderbook->tryCancelOrder(order_ids[i]);
+        if (journal_ && cancelled[i]) journalEvent(JournalEvent::CANCEL, symbols[i], order_ids[i]);
+    }
+}
+
+bool OrderBookManager::tryCancelOrder(SymbolId symbol, OrderId order_id) {
+    requireSync();
+    auto* orderbook = getOrderBook(symbol);
+    bool cancelled = orderbook && orderbook->tryCancelOrder(order_id);
+    if (journal_ && cancelled) journalEvent(JournalEvent::CANCEL, symbol, order_id);
+    return cancelled;
+}
+
+void OrderBookManager::cancelOrder(SymbolId symbol, OrderId order_id) {
+    requireSync();
+    requireOrderBook(symbol).cancelOrder(order_id);
+    if (journal_) journalEvent(JournalEvent::CANCEL, symbol, order_id);
 }
 
 std::vector<Trade> OrderBookManager::processOrders() {
+    const auto& book_trades = processOrdersByBook();
+    size_t total = 0;
+    for (const auto& trades : book_trades) {
+        total += trades.size();
+    }
     std::vector<Trade> all_trades;
-    for (auto& [symbol, orderbook] : orderbooks_) {
-        auto trades = orderbook->matchOrders();
+    all_trades.reserve(total);
+    for (const auto& trades : book_trades) {
         all_trades.insert(all_trades.end(), trades.begin(), trades.end());
     }
     return all_trades;
 }
 
-double OrderBookManager::getBestBid(const std::string& symbol) const {
-    const auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + symbol);
+const std::vector<std::vector<Trade>>& OrderBookManager::processOrdersByBook() {
+    requireSync();
+    clock_->onBatchStart();
+    uint64_t now = clock_->now(); //One stamp for every book's trades and the BATCH record
+    book_trades_.resize(orderbooks_.size());
+
+    //Books still shared with a fork are only copied if this pass would change them
+    for (size_t index = 0; index < orderbooks_.size(); index++) {
+        const auto& orderbook = orderbooks_[index];
+        if (orderbook && (orderbook.use_count() == 1 || orderbook->needsMatching())) {
+            getOrderBook(static_cast<SymbolId>(index));
+        }
+    }
+
+    //Books share nothing (the pass time was read above), so each one
+    //can be matched on any worker and write into its own slot
+    auto match_book = [this, now](size_t index, size_t) {
+        auto& orderbook = orderbooks_[index];
+        if (orderbook && orderbook.use_count() == 1) {
+            book_trades_[index] = orderbook->matchOrders(now);
+        } else {
+            book_trades_[index].clear();
+        }
+    };
+
+    if (workers_) {
+        workers_->parallelFor(orderbooks_.size(), match_book, partition_);
+    } else {
+        for (size_t index = 0; index < orderbooks_.size(); index++) {
+            match_book(index, 0);
+        }
+    }
+
+    //Written after the pass so parallel matching never touches the journal
+    if (journal_) {
+        journal_->appendEvent(JournalEvent::BATCH, 0, now);
+        for (const auto& trades : book_trades_) {
+            for (const Trade& trade : trades) {
+                journal_->appendTrade(trade);
+            }
+        }
     }
-    return orderbook->getBestBid();
+    return book_trades_;
 }
 
-double OrderBookManager::getBestAsk(const std::string& symbol) const {
-    const auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + symbol);
+const TradeTape& OrderBookManager::processOrdersToTape() {
+    tape_.clear();
+    const auto& book_trades = processOrdersByBook();
+    size_t total = 0;
+    for (const auto& trades : book_trades) {
+        total += trades.size();
     }
-    return orderbook->getBestAsk();
+    tape_.reserve(total);
+    for (const auto& trades : book_trades) {
+        tape_.append(trades);
+    }
+    return tape_;
 }
 
-int OrderBookManager::getBidSize(const std::string& symbol) const {
-    const auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + symbol);
+void OrderBookManager::setWorkerThreads(size_t workers, Partition partition, bool pin_threads) {
+    partition_ = partition;
+    if (workers <= 1) {
+        workers_.reset();
+    } else {
+        workers_ = std::make_unique<ThreadPool>(workers, pin_threads);
     }
-    return orderbook->getBidSize();
 }
 
-int OrderBookManager::getAskSize(const std::string& symbol) const {
-    const auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + symbol);
+double OrderBookManager::getBestBid(SymbolId symbol) const {
+    return requireOrderBook(symbol).getBestBid();
+}
+
+double OrderBookManager::getBestAsk(SymbolId symbol) const {
+    return requireOrderBook(symbol).getBestAsk();
+}
+
+int OrderBookManager::getBidSize(SymbolId symbol) const {
+    return requireOrderBook(symbol).getBidSize();
+}
+
+int OrderBookManager::getAskSize(SymbolId symbol) const {
+    return requireOrderBook(symbol).getAskSize();
+}
+
+std::vector<std::pair<double, int>> OrderBookManager::getBidDepth(SymbolId symbol, int levels) const {
+    return requireOrderBook(symbol).getBidDepth(levels);
+}
+
+std::vector<std::pair<double, int>> OrderBookManager::getAskDepth(SymbolId symbol, int levels) const {
+    return requireOrderBook(symbol).getAskDepth(levels);
+}
+
+void OrderBookManager::snapshot(const SymbolId* symbols, size_t count, int levels, const MarketSnapshot& out) const {
+    ORDERBOOK_STATS_TIMER(StatsOp::SNAPSHOT);
+    levels = std::max(levels, 0);
+    for (size_t i = 0; i < count; i++) {
+        const OrderBook& book = requireOrderBook(symbols[i]);
+        double bid = book.getBestBid();
+        double ask = book.getBestAsk();
+        bool quoted = book.getBidOrderCount() > 0 && book.getAskOrderCount() > 0;
+
+        if (out.best_bid) out.best_bid[i] = bid;
+        if (out.best_ask) out.best_ask[i] = ask;
+        if (out.mid) out.mid[i] = quoted ? (bid + ask) / 2 : NAN;
+        if (out.spread) out.spread[i] = quoted ? ask - bid : NAN;
+        if (out.bid_size) out.bid_size[i] = book.getBidSize();
+        if (out.ask_size) out.ask_size[i] = book.getAskSize();
+
+        size_t row = i * static_cast<size_t>(levels);
+        if (out.bid_prices && out.bid_quantities) {
+            int filled = book.copyBidDepth(levels, out.bid_prices + row, out.bid_quantities + row);
+            std::fill(out.bid_prices + row + filled, out.bid_prices + row + levels, 0.0);
+            std::fill(out.bid_quantities + row + filled, out.bid_quantities + row + levels, 0);
+        }
+        if (out.ask_prices && out.ask_quantities) {
+            int filled = book.copyAskDepth(levels, out.ask_prices + row, out.ask_quantities + row);
+            std::fill(out.ask_prices + row + filled, out.ask_prices + row + levels, 0.0);
+            std::fill(out.ask_quantities + row + filled, out.ask_quantities + row + levels, 0);
+        }
     }
-    return orderbook->getAskSize();
 }
 
-std::vector<std::pair<double, int>> OrderBookManager::getBidDepth(
-    const std::string& symbol, int levels) const {
+bool OrderBookManager::hasOrder(SymbolId symbol, OrderId order_id) const {
     const auto* orderbook = getOrderBook(symbol);
     if (!orderbook) {
-        throw std::runtime_error("No orderbook found for symbol: " + symbol);
+        return false;
     }
-    return orderbook->getBidDepth(levels);
+    return orderbook->hasOrder(order_id);
 }
 
-std::vector<std::pair<double, int>> OrderBookManager::getAskDepth(
-    const std::string& symbol, int levels) const {
+const Order* OrderBookManager::getOrder(SymbolId symbol, OrderId order_id) const {
     const auto* orderbook = getOrderBook(symbol);
     if (!orderbook) {
+        return nullptr;
+    }
+    return orderbook->getOrder(order_id);
+}
+
+void OrderBookManager::setMatchingMode(SymbolId symbol, MatchingMode mode) {
+    requireSync();
+    requireOrderBook(symbol).setMatchingMode(mode);
+    if (journal_) journalEvent(JournalEvent::MODE, symbol, 0, 0.0, static_cast<int32_t>(mode));
+}
+
+MatchingMode OrderBookManager::getMatchingMode(SymbolId symbol) const {
+    return requireOrderBook(symbol).getMatchingMode();
+}
+
+void OrderBookManager::setTradeSink(TradeSink* sink) {
+    requireSync();
+    trade_sink_ = sink;
+    for (auto& orderbook : orderbooks_) {
+        if (orderbook && orderbook.use_count() == 1) orderbook->setTradeSink(sink); //Shared ones on copy
+    }
+}
+
+void OrderBookManager::setMarketDataSink(MarketDataSink* sink) {
+    requireSync();
+    market_data_sink_ = sink;
+    for (size_t index = 0; index < orderbooks_.size(); index++) {
+        if (!orderbooks_[index]) continue;
+        bool resubscribe = orderbooks_[index]->getMarketDataSink() == sink;
+        OrderBook* orderbook = getOrderBook(static_cast<SymbolId>(index)); //Installs a different sink itself
+        if (resubscribe && sink) orderbook->setMarketDataSink(sink); //Same sink again: resend the book
+    }
+}
+
+void OrderBookManager::startAsync(size_t shards, size_t queue_capacity, bool pin_threads) {
+    requireSync();
+    if (journal_) {
+        throw std::runtime_error("Async mode cannot run while a journal is attached");
+    }
+    std::vector<OrderBook*> books;
+    books.reserve(orderbooks_.size());
+    for (size_t index = 0; index < orderbooks_.size(); index++) {
+        books.push_back(getOrderBook(static_cast<SymbolId>(index))); //Matching threads own them from here
+    }
+    async_ = std::make_unique<AsyncEngine>(books, shards, queue_capacity, pin_threads);
+}
+
+void OrderBookManager::stopAsync() {
+    if (async_) {
+        async_->stop();
+    }
+}
+
+bool OrderBookManager::postOrder(const Order& order) {
+    if (!isAsync()) {
+        throw std::runtime_error("Async mode is not running");
+    }
+    return async_->postOrder(order);
+}
+
+bool OrderBookManager::postCancel(SymbolId symbol, OrderId order_id) {
+    if (!isAsync()) {
+        throw std::runtime_error("Async mode is not running");
+    }
+    return async_->postCancel(symbol, order_id);
+}
+
+size_t OrderBookManager::pollEvents(std::vector<EngineEvent>& out, size_t max_events) {
+    return async_ ? async_->pollEvents(out, max_events) : 0;
+}
+
+//------------ String edge ----------------
+
+SymbolId OrderBookManager::getSymbolId(const std::string& symbol) const {
+    SymbolId id;
+    if (!symbols_->find(symbol, id) || !getOrderBook(id)) {
         throw std::runtime_error("No orderbook found for symbol: " + symbol);
     }
-    return orderbook->getAskDepth(levels);
+    return id;
+}
+
+const std::string& OrderBookManager::getSymbolName(SymbolId symbol) const {
+    return symbols_->name(symbol);
+}
+
+std::string OrderBookManager::getOrderIdName(OrderId order_id) const {
+    return order_ids_->contains(order_id) ? order_ids_->name(order_id) : std::to_string(order_id);
+}
+
+std::string OrderBookManager::getClientIdName(ClientId client_id) const {
+    return client_ids_->contains(client_id) ? client_ids_->name(client_id) : std::to_string(client_id);
+}
+
+void OrderBookManager::cancelOrder(const std::string& symbol, const std::string& order_id) {
+    requireSync();
+    OrderBook& orderbook = requireOrderBook(getSymbolId(symbol));
+    OrderId id;
+    if (!order_ids_->find(order_id, id)) {
+        throw std::runtime_error("Order not found");
+    }
+    orderbook.cancelOrder(id);
+    if (journal_) journalEvent(JournalEvent::CANCEL, orderbook.getSymbol(), id);
+}
+
+bool OrderBookManager::tryCancelOrder(const std::string& symbol, const std::string& order_id) {
+    requireSync();
+    SymbolId symbol_id;
+    OrderId id;
+    if (!symbols_->find(symbol, symbol_id) || !order_ids_->find(order_id, id)) {
+        return false;
+    }
+    return tryCancelOrder(symbol_id, id);
+}
+
+double OrderBookManager::getTickSize(const std::string& symbol) const {
+    return requireOrderBook(getSymbolId(symbol)).getTickSize();
+}
+
+OrderBook::AllocationStats OrderBookManager::getAllocationStats(const std::string& symbol) const {
+    return requireOrderBook(getSymbolId(symbol)).getAllocationStats();
 }
 
 bool OrderBookManager::hasOrder(const std::string& symbol, const std::string& order_id) const {
-    const auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
+    SymbolId symbol_id;
+    OrderId id;
+    if (!symbols_->find(symbol, symbol_id) || !order_ids_->find(order_id, id)) {
         return false;
     }
-    return orderbook->hasOrder(order_id);
+    return hasOrder(symbol_id, id);
 }
 
 const Order* OrderBookManager::getOrder(const std::string& symbol, const std::string& order_id) const {
-    const auto* orderbook = getOrderBook(symbol);
-    if (!orderbook) {
+    SymbolId symbol_id;
+    OrderId id;
+    if (!symbols_->find(symbol, symbol_id) || !order_ids_->find(order_id, id)) {
         return nullptr;
     }
-    return orderbook->getOrder(order_id);
+    return getOrder(symbol_id, id);
 }
 
-OrderBook* OrderBookManager::getOrderBook(const std::string& symbol) {
-    auto it = orderbooks_.find(symbol);
-    return it != orderbooks_.end() ? it->second.get() : nullptr;
+//------------ Helper methods ----------------
+
+OrderBook* OrderBookManager::getOrderBook(SymbolId symbol) {
+    if (symbol >= orderbooks_.size() || !orderbooks_[symbol]) {
+        return nullptr;
+    }
+    OrderBook& orderbook = unshare(orderbooks_[symbol]);
+    //A copy, or a book this manager inherited from its parent, still points at the other manager's clock and sinks
+    if (orderbook.getClock() != clock_.get() || orderbook.getTradeSink() != trade_sink_) {
+        orderbook.setClock(clock_.get());
+        orderbook.setTradeSink(trade_sink_);
+    }
+    if (orderbook.getMarketDataSink() != market_data_sink_) {
+        orderbook.setMarketDataSink(market_data_sink_);
+    }
+    return &orderbook;
 }
 
-const OrderBook* OrderBookManager::getOrderBook(const std::string& symbol) const {
-    auto it = orderbooks_.find(symbol);
-    return it != orderbooks_.end() ? it->second.get() : nullptr;
-} 
\ No newline at end of file
+const OrderBook* OrderBookManager::getOrderBook(SymbolId symbol) const {
+    return symbol < orderbooks_.size() ? orderbooks_[symbol].get() : nullptr;
+}
+
+void OrderBookManager::requireSync() const {
+    if (isAsync()) {
+        throw std::runtime_error("Not available while async mode is running");
+    }
+}
+
+void OrderBookManager::journalEvent(JournalEvent event, SymbolId symbol, OrderId order_id, double price, int32_t quantity) {
+    journal_->appendEvent(event, symbol, clock_->now(), order_id, price, quantity);
+}
+
+OrderBook& OrderBookManager::requireOrderBook(SymbolId symbol) {
+    auto* orderbook = getOrderBook(symbol);
+    if (!orderbook) {
+        throw std::runtime_error("No orderbook found for symbol id: " + std::to_string(symbol));
+    }
+    return *orderbook;
+}
+
+const OrderBook& OrderBookManager::requireOrderBook(SymbolId symbol) const {
+    const auto* orderbook = getOrderBook(symbol);
+    if (!orderbook) {
+        throw std::runtime_error("No orderbook found for symbol id: " + std::to_string(symbol));
+    }
+    return *orderbook;
+}
@@ -0,0 +1,117 @@
+#include "OrderIndex.hpp"
+#include <algorithm>
+
+namespace {
+
+size_t roundCapacity(size_t capacity) {
+    size_t rounded = 16;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+unsigned shiftFor(size_t capacity) {
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < capacity) {
+        bits++;
+    }
+    return 64 - bits;
+}
+
+} // namespace
+
+OrderIndex::OrderIndex(size_t initial_capacity)
+    : slots_(roundCapacity(initial_capacity), nullptr),
+      mask_(slots_.size() - 1),
+      shift_(shiftFor(slots_.size())),
+      size_(0),
+      rehashes_(0) {}
+
+//Home slot for an id; probing continues linearly from here.
+//Fibonacci hashing spreads sequential ids across the table.
+size_t OrderIndex::slotFor(OrderId order_id) const {
+    return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ULL) >> shift_);
+}
+
+OrderNode* OrderIndex::find(OrderId order_id) const {
+    for (size_t slot = slotFor(order_id);; slot = (slot + 1) & mask_) {
+        OrderNode* node = slots_[slot];
+        if (!node) {
+            return nullptr;
+        }
+        if (node->order.order_id == order_id) {
+            return node;
+        }
+    }
+}
+
+void OrderIndex::insert(OrderNode* node) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+        grow();
+    }
+    for (size_t slot = slotFor(node->order.order_id);; slot = (slot + 1) & mask_) {
+        OrderNode*& current = slots_[slot];
+        if (!current) {
+            current = node;
+            size_++;
+            return;
+        }
+        if (current->order.order_id == node->order.order_id) {
+            current = node;
+            return;
+        }
+    }
+}
+
+void OrderIndex::erase(const OrderNode* node) {
+    size_t slot = slotFor(node->order.order_id);
+    while (slots_[slot] != node) {
+        if (!slots_[slot]) {
+            return;
+        }
+        slot = (slot + 1) & mask_;
+    }
+
+    //Backward-shift deletion: pull later entries of the probe run into the hole
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask_; slots_[next]; next = (next + 1) & mask_) {
+        size_t home = slotFor(slots_[next]->order.order_id);
+        if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = nullptr;
+    size_--;
+}
+
+void OrderIndex::clear() {
+    std::fill(slots_.begin(), slots_.end(), nullptr);
+    size_ = 0;
+}
+
+void OrderIndex::reserve(size_t count) {
+    if (count * 2 > slots_.size()) {
+        rehash(roundCapacity(count * 2));
+    }
+}
+
+void OrderIndex::grow() {
+    rehash(slots_.size() * 2);
+}
+
+void OrderIndex::rehash(size_t capacity) {
+    std::vector<OrderNode*> old_slots(capacity, nullptr);
+    old_slots.swap(slots_);
+    mask_ = slots_.size() - 1;
+    shift_ = shiftFor(slots_.size());
+    size_ = 0;
+    rehashes_++;
+
+    for (OrderNode* node : old_slots) {
+        if (node) {
+            insert(node);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "OrderPool.hpp"
+#include <utility>
+
+OrderPool::OrderPool(size_t slab_size)
+    : slab_size_(slab_size > 0 ? slab_size : 1),
+      free_list_(nullptr) {}
+
+OrderNode* OrderPool::acquire(const Order& order) {
+    if (!free_list_) {
+        addSlab();
+    }
+    OrderNode* node = free_list_;
+    free_list_ = node->next;
+
+    node->order = order;
+    node->prev = nullptr;
+    node->next = nullptr;
+
+    stats_.acquired++;
+    stats_.in_use++;
+    return node;
+}
+
+void OrderPool::release(OrderNode* node) {
+    node->prev = nullptr;
+    node->next = free_list_;
+    free_list_ = node;
+
+    stats_.released++;
+    stats_.in_use--;
+}
+
+void OrderPool::reset() {
+    free_list_ = nullptr;
+    for (auto& slab : slabs_) {
+        for (size_t i = 0; i < slab.size; ++i) {
+            slab.nodes[i].prev = nullptr;
+            slab.nodes[i].next = free_list_;
+            free_list_ = &slab.nodes[i];
+        }
+    }
+    stats_.released += stats_.in_use;
+    stats_.in_use = 0;
+}
+
+//Splices the shorter free list onto the longer one, so the cost is the smaller pool's spare nodes
+void OrderPool::adopt(OrderPool& other) {
+    OrderNode* shorter = other.free_list_;
+    OrderNode* longer = free_list_;
+    if (other.stats_.capacity - other.stats_.in_use > stats_.capacity - stats_.in_use) {
+        std::swap(shorter, longer);
+    }
+    if (shorter) {
+        OrderNode* tail = shorter;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = longer;
+        longer = shorter;
+    }
+    free_list_ = longer;
+    other.free_list_ = nullptr;
+
+    for (Slab& slab : other.slabs_) {
+        slabs_.push_back(std::move(slab));
+    }
+    other.slabs_.clear();
+    stats_.slab_allocations += other.stats_.slab_allocations;
+    stats_.acquired += other.stats_.acquired;
+    stats_.released += other.stats_.released;
+    stats_.capacity += other.stats_.capacity;
+    stats_.in_use += other.stats_.in_use;
+    other.stats_ = Stats();
+}
+
+void OrderPool::addSlab() {
+    slabs_.push_back({std::unique_ptr<OrderNode[]>(new OrderNode[slab_size_]), slab_size_});
+    OrderNode* slab = slabs_.back().nodes.get();
+    for (size_t i = slab_size_; i-- > 0;) {
+        slab[i].next = free_list_;
+        free_list_ = &slab[i];
+    }
+    stats_.slab_allocations++;
+    stats_.capacity += slab_size_;
+}
@@ -0,0 +1,286 @@
+#include "PriceLadder.hpp"
+#include "EngineStats.hpp"
+#include <algorithm>
+#include <stdexcept>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline int highestBit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(word);
+#endif
+}
+
+inline int lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+//Capacity is always a power of two and at least one bitmap word
+size_t roundCapacity(size_t levels) {
+    size_t capacity = 64;
+    while (capacity < levels) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+} // namespace
+
+PriceLadder::PriceLadder(Side side, size_t initial_levels, size_t max_levels)
+    : side_(side),
+      base_(0),
+      occupied_(0),
+      max_levels_(std::max(roundCapacity(max_levels), roundCapacity(initial_levels))),
+      total_quantity_(0),
+      order_count_(0) {
+    levels_.resize(roundCapacity(initial_levels));
+    buildLayers(levels_.size());
+}
+
+//------------ Level access ----------------
+
+PriceLevel& PriceLadder::getOrCreate(Price price) {
+    ensureRange(price);
+    size_t index = static_cast<size_t>(price - base_);
+    if (!isSet(index)) {
+        setBit(index);
+        occupied_++;
+        ORDERBOOK_STATS_COUNT(StatsCounter::LEVELS_CREATED, 1);
+    }
+    return levels_[index];
+}
+
+PriceLevel* PriceLadder::find(Price price) {
+    if (!inRange(price)) {
+        return nullptr;
+    }
+    size_t index = static_cast<size_t>(price - base_);
+    return isSet(index) ? &levels_[index] : nullptr;
+}
+
+const PriceLevel* PriceLadder::find(Price price) const {
+    if (!inRange(price)) {
+        return nullptr;
+    }
+    size_t index = static_cast<size_t>(price - base_);
+    return isSet(index) ? &levels_[index] : nullptr;
+}
+
+void PriceLadder::release(Price price) {
+    if (!inRange(price)) {
+        return;
+    }
+    size_t index = static_cast<size_t>(price - base_);
+    if (isSet(index)) {
+        clearBit(index);
+        occupied_--;
+        ORDERBOOK_STATS_COUNT(StatsCounter::LEVELS_DESTROYED, 1);
+    }
+}
+
+bool PriceLadder::canHold(Price price) const {
+    if (inRange(price) || empty()) {
+        return true;
+    }
+    Price lo = std::min(price, base_ + static_cast<Price>(lowestIndex()));
+    Price hi = std::max(price, base_ + static_cast<Price>(highestIndex()));
+    return static_cast<uint64_t>(hi - lo) < max_levels_;
+}
+
+Price PriceLadder::best() const {
+    if (empty()) {
+        return NO_PRICE;
+    }
+    size_t index = side_ == Side::BUY ? highestIndex() : lowestIndex();
+    return base_ + static_cast<Price>(index);
+}
+
+Price PriceLadder::next(Price price) const {
+    if (empty()) {
+        return NO_PRICE;
+    }
+    // Clamp prices outside the array so walking still works from any start point
+    if (price < base_) {
+        return side_ == Side::BUY ? NO_PRICE : best();
+    }
+    if (price >= base_ + static_cast<Price>(levels_.size())) {
+        return side_ == Side::BUY ? best() : NO_PRICE;
+    }
+
+    size_t index = static_cast<size_t>(price - base_);
+    int64_t found = side_ == Side::BUY ? findBelow(0, index) : findAbove(0, index);
+    return found < 0 ? NO_PRICE : base_ + found;
+}
+
+//Keeps the current capacity so clearing a book does not reallocate
+void PriceLadder::clear() {
+    std::fill(levels_.begin(), levels_.end(), PriceLevel{});
+    for (auto& layer : bits_) {
+        std::fill(layer.begin(), layer.end(), 0);
+    }
+    occupied_ = 0;
+    total_quantity_ = 0;
+    order_count_ = 0;
+}
+
+//------------ Bitmap helpers ----------------
+
+bool PriceLadder::inRange(Price price) const {
+    return price >= base_ && price - base_ < static_cast<Price>(levels_.size());
+}
+
+bool PriceLadder::isSet(size_t index) const {
+    return (bits_[0][index >> 6] >> (index & 63)) & 1;
+}
+
+void PriceLadder::setBit(size_t index) {
+    for (auto& layer : bits_) {
+        uint64_t& word = layer[index >> 6];
+        bool was_empty = word == 0;
+        word |= uint64_t(1) << (index & 63);
+        if (!was_empty) {
+            break; // Parents already mark this word as occupied
+        }
+        index >>= 6;
+    }
+}
+
+void PriceLadder::clearBit(size_t index) {
+    for (auto& layer : bits_) {
+        uint64_t& word = layer[index >> 6];
+        word &= ~(uint64_t(1) << (index & 63));
+        if (word != 0) {
+            break; // Word still has occupied levels, parents stay set
+        }
+        index >>= 6;
+    }
+}
+
+void PriceLadder::buildLayers(size_t capacity) {
+    bits_.clear();
+    size_t words = capacity / 64;
+    while (true) {
+        bits_.emplace_back(words, 0);
+        if (words == 1) {
+            break;
+        }
+        words = (words + 63) / 64;
+    }
+}
+
+size_t PriceLadder::highestIndex() const {
+    return descendHighest(bits_.size() - 1, 0);
+}
+
+size_t PriceLadder::lowestIndex() const {
+    return descendLowest(bits_.size() - 1, 0);
+}
+
+//Highest set index in `layer` strictly below `index`, or -1
+int64_t PriceLadder::findBelow(size_t layer, size_t index) const {
+    size_t word = index >> 6;
+    uint64_t masked = bits_[layer][word] & ((uint64_t(1) << (index & 63)) - 1);
+    if (masked) {
+        return static_cast<int64_t>(word * 64 + highestBit(masked));
+    }
+    if (layer + 1 == bits_.size()) {
+        return -1;
+    }
+    int64_t parent = findBelow(layer + 1, word); //Nearest non-empty word below this one
+    if (parent < 0) {
+        return -1;
+    }
+    return parent * 64 + highestBit(bits_[layer][static_cast<size_t>(parent)]);
+}
+
+//Lowest set index in `layer` strictly above `index`, or -1
+int64_t PriceLadder::findAbove(size_t layer, size_t index) const {
+    size_t word = index >> 6;
+    unsigned bit = index & 63;
+    uint64_t masked = bit == 63 ? 0 : bits_[layer][word] & (~uint64_t(0) << (bit + 1));
+    if (masked) {
+        return static_cast<int64_t>(word * 64 + lowestBit(masked));
+    }
+    if (layer + 1 == bits_.size()) {
+        return -1;
+    }
+    int64_t parent = findAbove(layer + 1, word); //Nearest non-empty word above this one
+    if (parent < 0) {
+        return -1;
+    }
+    return parent * 64 + lowestBit(bits_[layer][static_cast<size_t>(parent)]);
+}
+
+//Follow the highest set bit from word `word` of `layer` down to a level index
+size_t PriceLadder::descendHighest(size_t layer, size_t word) const {
+    size_t index = word;
+    for (size_t l = layer + 1; l-- > 0;) {
+        index = index * 64 + highestBit(bits_[l][index]);
+    }
+    return index;
+}
+
+size_t PriceLadder::descendLowest(size_t layer, size_t word) const {
+    size_t index = word;
+    for (size_t l = layer + 1; l-- > 0;) {
+        index = index * 64 + lowestBit(bits_[l][index]);
+    }
+    return index;
+}
+
+//Make sure `price` maps into levels_, re-centring or growing the array around
+//the occupied span when it does not. Existing levels are moved, not copied.
+void PriceLadder::ensureRange(Price price) {
+    if (inRange(price)) {
+        return;
+    }
+    if (empty()) {
+        base_ = price - static_cast<Price>(levels_.size() / 2);
+        return;
+    }
+
+    Price lowest = base_ + static_cast<Price>(lowestIndex());
+    Price highest = base_ + static_cast<Price>(highestIndex());
+    Price lo = std::min(price, lowest);
+    Price hi = std::max(price, highest);
+    if (static_cast<uint64_t>(hi - lo) >= max_levels_) {
+        throw std::runtime_error("Price is outside the supported ladder range");
+    }
+
+    size_t span = static_cast<size_t>(hi - lo) + 1;
+    size_t capacity = levels_.size();
+    while (capacity < span * 2 && capacity < max_levels_) {
+        capacity *= 2;
+    }
+    Price new_base = lo - static_cast<Price>((capacity - span) / 2);
+
+    std::vector<PriceLevel> levels(capacity);
+    std::vector<size_t> moved;
+    moved.reserve(occupied_);
+    for (int64_t index = static_cast<int64_t>(lowestIndex()); index >= 0;
+         index = findAbove(0, static_cast<size_t>(index))) {
+        size_t target = static_cast<size_t>(base_ + index - new_base);
+        levels[target] = std::move(levels_[static_cast<size_t>(index)]);
+        moved.push_back(target);
+    }
+
+    levels_.swap(levels);
+    buildLayers(capacity);
+    for (size_t index : moved) {
+        setBit(index);
+    }
+    base_ = new_base;
+}
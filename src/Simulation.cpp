@@ -0,0 +1,199 @@
+#include "Simulation.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+Simulation::Simulation(SimulationConfig config)
+    : config_(std::move(config)),
+      clock_(nullptr),
+      rng_(config_.seed),
+      unit_normal_(0.0, 1.0),
+      step_(0),
+      next_order_id_(1),
+      arrival_sequence_(0),
+      orders_submitted_(0),
+      orders_rejected_(0),
+      trade_count_(0) {
+    if (config_.symbols.empty()) {
+        throw std::invalid_argument("Simulation needs at least one symbol");
+    }
+    if (config_.dt <= 0.0) {
+        throw std::invalid_argument("Simulation step length must be positive");
+    }
+
+    auto clock = std::make_unique<SimulatedClock>();
+    clock_ = clock.get();
+    manager_.setClock(std::move(clock));
+
+    for (const std::string& symbol : config_.symbols) {
+        symbol_ids_.push_back(manager_.addOrderBook(symbol, config_.tick_size));
+        fundamental_.push_back(config_.initial_mid);
+    }
+    seedBooks();
+}
+
+AgentId Simulation::addAgent(const std::string& name, SymbolId symbol, std::shared_ptr<Agent> agent) {
+    if (!agent) {
+        throw std::invalid_argument("Agent " + name + " is null");
+    }
+    if (std::find(symbol_ids_.begin(), symbol_ids_.end(), symbol) == symbol_ids_.end()) {
+        throw std::invalid_argument("Agent " + name + " trades an unknown symbol");
+    }
+    AgentId id = static_cast<AgentId>(agents_.size());
+    Participant participant;
+    participant.account.name = name;
+    participant.account.symbol = symbol;
+    participant.account.client_id = static_cast<ClientId>(id) + 1;
+    participant.agent = std::move(agent);
+    agents_.push_back(std::move(participant));
+    return id;
+}
+
+void Simulation::run() {
+    while (step_ < config_.num_steps) {
+        step();
+    }
+}
+
+void Simulation::step() {
+    manager_.setSimulationTime(now());
+    uint64_t now_ns = clock_->now();
+
+    quoteFundamentals(now_ns);
+    releaseArrivals(now_ns);
+
+    for (size_t i = 0; i < agents_.size(); i++) {
+        MarketView market{manager_, agents_[i].account.symbol, step_, now(),
+                          config_.fee_per_order, config_.fee_per_share};
+        AgentOrders orders(*this, static_cast<AgentId>(i));
+        agents_[i].agent->onStep(market, orders);
+    }
+
+    settle(manager_.processOrdersByBook());
+
+    if (config_.record_interval != 0 && step_ % config_.record_interval == 0) {
+        record();
+    }
+    step_++;
+}
+
+void Simulation::submitOrder(AgentId agent, Order order) {
+    AgentAccount& account = agents_.at(agent).account;
+    order.client_id = account.client_id;
+    account.pnl -= config_.fee_per_order;
+    orders_submitted_++;
+
+    double latency = std::max(0.0, config_.latency_mean + config_.latency_std * unit_normal_(rng_));
+    uint64_t arrival_ns = clock_->now() + static_cast<uint64_t>(latency * 1e9 + 0.5);
+    arrivals_.push(Arrival{arrival_ns, arrival_sequence_++, order});
+}
+
+bool Simulation::cancelOrder(SymbolId symbol, OrderId order_id) {
+    return manager_.tryCancelOrder(symbol, order_id);
+}
+
+double Simulation::getFundamentalMid(SymbolId symbol) const {
+    auto it = std::find(symbol_ids_.begin(), symbol_ids_.end(), symbol);
+    if (it == symbol_ids_.end()) {
+        throw std::invalid_argument("No fundamental for symbol id: " + std::to_string(symbol));
+    }
+    return fundamental_[it - symbol_ids_.begin()];
+}
+
+//------------ Step phases ----------------
+
+//Initial liquidity so agents see a two-sided book from the first step
+void Simulation::seedBooks() {
+    std::vector<Order> seed;
+    for (size_t i = 0; i < symbol_ids_.size(); i++) {
+        for (Side side : {Side::BUY, Side::SELL}) {
+            for (int level = 1; level <= config_.seed_levels; level++) {
+                double offset = level * config_.seed_tick;
+                double price = side == Side::BUY ? fundamental_[i] - offset : fundamental_[i] + offset;
+                seed.emplace_back(nextOrderId(), 0, symbol_ids_[i], side, price, config_.seed_quantity);
+            }
+        }
+    }
+    std::vector<SubmitResult> results(seed.size());
+    manager_.submitOrders(seed.data(), seed.size(), results.data());
+}
+
+//All bids then all asks, as one batch
+void Simulation::quoteFundamentals(uint64_t now_ns) {
+    size_t count = symbol_ids_.size();
+    for (size_t i = 0; i < count; i++) {
+        fundamental_[i] += config_.fund_volatility * unit_normal_(rng_);
+    }
+
+    fund_orders_.resize(2 * count);
+    fund_results_.resize(2 * count);
+    for (size_t i = 0; i < 2 * count; i++) {
+        size_t symbol = i % count;
+        bool buy = i < count;
+        //Filled field by field: a mid that has drifted to a non-positive price is REJECTED, not thrown
+        Order& order = fund_orders_[i];
+        order.order_id = nextOrderId();
+        order.client_id = 0;
+        order.symbol = symbol_ids_[symbol];
+        order.side = buy ? Side::BUY : Side::SELL;
+        order.price = buy ? fundamental_[symbol] - config_.fund_half_spread : fundamental_[symbol] + config_.fund_half_spread;
+        order.quantity = config_.fund_quantity;
+        order.type = OrderType::LIMIT;
+        order.tif = TimeInForce::GTC;
+        order.timestamp = now_ns;
+    }
+    manager_.submitOrders(fund_orders_.data(), fund_orders_.size(), fund_results_.data());
+}
+
+void Simulation::releaseArrivals(uint64_t now_ns) {
+    while (!arrivals_.empty() && arrivals_.top().time_ns <= now_ns) {
+        Order order = arrivals_.top().order;
+        arrivals_.pop();
+        order.timestamp = now_ns;
+
+        SubmitResult result;
+        manager_.submitOrders(&order, 1, &result); //Validates instead of throwing
+        if (result.status == SubmitStatus::REJECTED) {
+            orders_rejected_++;
+        }
+    }
+}
+
+void Simulation::settle(const std::vector<std::vector<Trade>>& book_trades) {
+    for (const auto& trades : book_trades) {
+        for (const Trade& trade : trades) {
+            double notional = trade.quantity * trade.price;
+            double fee = config_.fee_per_share * trade.quantity;
+            if (AgentAccount* buyer = accountFor(trade.buyer_client_id)) {
+                buyer->pnl -= notional + fee;
+                buyer->inventory += trade.quantity;
+                buyer->trades++;
+            }
+            if (AgentAccount* seller = accountFor(trade.seller_client_id)) {
+                seller->pnl += notional - fee;
+                seller->inventory -= trade.quantity;
+                seller->trades++;
+            }
+        }
+        trade_count_ += trades.size();
+        if (config_.record_trades) {
+            trades_.append(trades);
+            trade_steps_.insert(trade_steps_.end(), trades.size(), step_);
+        }
+    }
+}
+
+//NAV marks inventory at the book mid, an empty side counting as 0 like simulation.py
+void Simulation::record() {
+    recorded_steps_.push_back(step_);
+    for (const Participant& participant : agents_) {
+        const AgentAccount& account = participant.account;
+        double mid = (manager_.getBestBid(account.symbol) + manager_.getBestAsk(account.symbol)) / 2;
+        pnl_history_.push_back(account.pnl);
+        inventory_history_.push_back(account.inventory);
+        nav_history_.push_back(account.pnl + account.inventory * mid);
+    }
+}
+
+AgentAccount* Simulation::accountFor(ClientId client_id) {
+    return client_id != 0 && client_id <= agents_.size() ? &agents_[client_id - 1].account : nullptr;
+}
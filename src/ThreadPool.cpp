@@ -0,0 +1,144 @@
+#include "ThreadPool.hpp"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+//Next CPU for a pinned worker, shared by every pool. CPU 0 is left to the
+//threads that build pools and call parallelFor.
+std::atomic<size_t> next_pinned_cpu{1};
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t workers, bool pin_threads)
+    : generation_(0),
+      active_(0),
+      stopping_(false),
+      task_(nullptr),
+      count_(0),
+      partition_(Partition::STATIC),
+      next_index_(0) {
+    if (workers == 0) {
+        workers = 1;
+    }
+    //Only the threads started here are pinned: the caller's affinity is not this pool's to change
+    size_t first_cpu = pin_threads ? next_pinned_cpu.fetch_add(workers - 1) : 0;
+    threads_.reserve(workers - 1);
+    for (size_t worker = 1; worker < workers; worker++) {
+        threads_.emplace_back([this, worker, pin_threads, cpu = first_cpu + worker - 1] {
+            if (pin_threads) {
+                pinCurrentThread(cpu);
+            }
+            workerLoop(worker);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const Task& task, Partition partition) {
+    if (count == 0) {
+        return;
+    }
+    if (threads_.empty() || count == 1) {
+        for (size_t index = 0; index < count; index++) {
+            task(index, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        partition_ = partition;
+        next_index_.store(0, std::memory_order_relaxed);
+        error_ = nullptr;
+        active_ = threads_.size();
+        generation_++;
+    }
+    work_ready_.notify_all();
+
+    runShare(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_done_.wait(lock, [this] { return active_ == 0; });
+    task_ = nullptr;
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+        }
+
+        runShare(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_--;
+        }
+        work_done_.notify_one();
+    }
+}
+
+//One worker's part of the current loop
+void ThreadPool::runShare(size_t worker) {
+    try {
+        if (partition_ == Partition::STATIC) {
+            size_t workers = workerCount();
+            size_t begin = count_ * worker / workers;
+            size_t end = count_ * (worker + 1) / workers;
+            for (size_t index = begin; index < end; index++) {
+                (*task_)(index, worker);
+            }
+        } else {
+            for (size_t index = next_index_.fetch_add(1, std::memory_order_relaxed); index < count_;
+                 index = next_index_.fetch_add(1, std::memory_order_relaxed)) {
+                (*task_)(index, worker);
+            }
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::pinCurrentThread(size_t cpu) {
+#ifdef __linux__
+    unsigned int cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set); //Best effort: ignored if not permitted
+#else
+    (void)cpu;
+#endif
+}
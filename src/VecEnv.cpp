@@ -0,0 +1,135 @@
+#include "VecEnv.hpp"
+#include <stdexcept>
+
+//Places the market order chosen for this step, if any
+class VecEnv::Learner : public Agent {
+public:
+    explicit Learner(int size) : size_(size), action_(HOLD) {}
+
+    void setAction(int32_t action) { action_ = action; }
+
+    void onStep(const MarketView& market, OrderSink& orders) override {
+        if (action_ == BUY || action_ == SELL) {
+            orders.submitOrder(Order(orders.nextOrderId(), 0, market.symbol,
+                                     action_ == BUY ? Side::BUY : Side::SELL, 0.0, size_, OrderType::MARKET));
+        }
+        action_ = HOLD;
+    }
+
+private:
+    int size_;
+    int32_t action_;
+};
+
+VecEnv::VecEnv(VecEnvConfig config, size_t envs, size_t workers, bool pin_threads)
+    : config_(std::move(config)),
+      envs_(envs),
+      observations_(envs * OBSERVATION_DIM, 0.0f),
+      rewards_(envs, 0.0f),
+      dones_(envs, 0) {
+    if (envs == 0) {
+        throw std::invalid_argument("VecEnv needs at least one environment");
+    }
+    if (config_.episode_length == 0 || config_.order_size <= 0) {
+        throw std::invalid_argument("Episode length and order size must be positive");
+    }
+    if (workers > 1) {
+        workers_ = std::make_unique<ThreadPool>(workers, pin_threads);
+    }
+    std::vector<uint64_t> seeds(envs);
+    for (size_t i = 0; i < envs; i++) {
+        seeds[i] = deriveSeed(config_.simulation.seed, i);
+    }
+    reset(seeds.data());
+}
+
+VecEnv::~VecEnv() = default;
+
+void VecEnv::reset(const uint64_t* seeds) {
+    auto task = [this, seeds](size_t index, size_t) {
+        envs_[index].seed = seeds[index];
+        envs_[index].episode = 0;
+        startEpisode(index);
+        rewards_[index] = 0.0f;
+        dones_[index] = 0;
+    };
+    if (workers_) {
+        workers_->parallelFor(envs_.size(), task);
+    } else {
+        for (size_t i = 0; i < envs_.size(); i++) task(i, 0);
+    }
+}
+
+void VecEnv::step(const int32_t* actions) {
+    //Envs share nothing and write only their own rows, so STATIC blocks need no locking
+    auto task = [this, actions](size_t index, size_t) { stepEnv(index, actions[index]); };
+    if (workers_) {
+        workers_->parallelFor(envs_.size(), task);
+    } else {
+        for (size_t i = 0; i < envs_.size(); i++) task(i, 0);
+    }
+}
+
+//------------ Per-env work ----------------
+
+void VecEnv::startEpisode(size_t index) {
+    Env& env = envs_[index];
+    uint64_t seed = env.episode == 0 ? env.seed : deriveSeed(env.seed, env.episode);
+    SimulationConfig config = config_.simulation;
+    config.seed = seed;
+    config.record_interval = 0;
+    config.num_steps = config_.episode_length;
+
+    env.simulation = std::make_unique<Simulation>(config);
+    addAgentMix(*env.simulation, config_.background, seed);
+    env.symbol = env.simulation->getSymbolIds().front();
+    env.learner = std::make_shared<Learner>(config_.order_size);
+    env.learner_id = env.simulation->addAgent("learner", env.symbol, env.learner);
+
+    const OrderBookManager& books = env.simulation->getManager();
+    env.previous_mid = (books.getBestBid(env.symbol) + books.getBestAsk(env.symbol)) / 2;
+    env.previous_nav = 0.0;
+    observe(index);
+}
+
+void VecEnv::stepEnv(size_t index, int32_t action) {
+    Env& env = envs_[index];
+    env.learner->setAction(action);
+    env.simulation->step();
+
+    const OrderBookManager& books = env.simulation->getManager();
+    double mid = (books.getBestBid(env.symbol) + books.getBestAsk(env.symbol)) / 2;
+    double nav = markedNav(env, mid);
+    rewards_[index] = static_cast<float>(nav - env.previous_nav);
+    env.previous_nav = nav;
+
+    if (env.simulation->currentStep() >= config_.episode_length) {
+        dones_[index] = 1;
+        env.episode++;
+        startEpisode(index);
+        return;
+    }
+    dones_[index] = 0;
+    observe(index);
+    env.previous_mid = mid;
+}
+
+void VecEnv::observe(size_t index) {
+    Env& env = envs_[index];
+    const OrderBookManager& books = env.simulation->getManager();
+    double bid = books.getBestBid(env.symbol);
+    double ask = books.getBestAsk(env.symbol);
+    double mid = (bid + ask) / 2;
+
+    float* row = &observations_[index * OBSERVATION_DIM];
+    row[0] = env.previous_mid > 0.0 ? static_cast<float>((mid - env.previous_mid) / env.previous_mid) : 0.0f;
+    row[1] = static_cast<float>(ask - bid);
+    row[2] = static_cast<float>(books.getBidSize(env.symbol));
+    row[3] = static_cast<float>(books.getAskSize(env.symbol));
+    row[4] = static_cast<float>(env.simulation->getAccount(env.learner_id).inventory);
+}
+
+double VecEnv::markedNav(const Env& env, double mid) const {
+    const AgentAccount& account = env.simulation->getAccount(env.learner_id);
+    return account.pnl + account.inventory * mid;
+}
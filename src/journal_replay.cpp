@@ -0,0 +1,47 @@
+#include "Journal.hpp"
+#include "OrderBookManager.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//Replays a journal written by OrderBookManager::setJournal into a fresh manager
+//as fast as possible and reports throughput and whether the trades matched.
+//Usage: journal_replay <journal> [repeats]
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <journal> [repeats]\n";
+        return 2;
+    }
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 1;
+
+    try {
+        JournalReader journal(argv[1]);
+        std::cout << "Journal: " << argv[1] << ", Records: " << journal.size() << "\n";
+
+        bool faithful = true;
+        for (int run = 0; run < repeats; run++) {
+            OrderBookManager manager;
+            ReplayStats stats = replayJournal(journal, manager);
+            //Journals from load_generator have no TRADE records: there is nothing to check trades against
+            bool checked = stats.journal_trades > 0;
+            faithful = faithful && stats.mismatched_trades == 0
+                && (!checked || stats.replay_trades == stats.journal_trades);
+
+            double rate = stats.seconds > 0 ? stats.records / stats.seconds : 0.0;
+            std::cout << "Run " << run
+                      << " - Orders: " << stats.orders
+                      << ", Cancels: " << stats.cancels
+                      << ", Batches: " << stats.batches
+                      << ", Trades: " << stats.replay_trades << "/"
+                      << (checked ? std::to_string(stats.journal_trades) : "unchecked")
+                      << ", Mismatched: " << stats.mismatched_trades
+                      << ", Seconds: " << stats.seconds
+                      << ", Records/s: " << static_cast<uint64_t>(rate) << "\n";
+        }
+        return faithful ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Replay failed: " << e.what() << "\n";
+        return 1;
+    }
+}
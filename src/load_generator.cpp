@@ -0,0 +1,122 @@
+#include "LoadGenerator.hpp"
+#include "OrderBookManager.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//Synthetic order flow for capacity tests. Drives a fresh OrderBookManager,
+//writes a journal for journal_replay, or (--generate-only) just measures the
+//generator. Prints message counts and rates.
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--messages N] [--symbols N] [--rate MSG_PER_S]\n"
+              << "       [--hawkes BRANCHING] [--decay PER_S] [--mix LIMIT,MARKET,CANCEL]\n"
+              << "       [--batch-mode] [--batch N] [--seed N]\n"
+              << "       [--journal <file> | --generate-only]\n";
+}
+
+void printRates(const LoadStats& stats, const char* engine) {
+    double total = stats.generate_seconds + stats.engine_seconds;
+    std::cout << "Messages: " << stats.messages
+              << ", Orders: " << stats.orders
+              << ", Cancels: " << stats.cancels
+              << ", Batches: " << stats.batches << "\n"
+              << "Generate: " << stats.generate_seconds << " s ("
+              << static_cast<uint64_t>(stats.generate_seconds > 0 ? stats.messages / stats.generate_seconds : 0.0)
+              << " msg/s), " << engine << ": " << stats.engine_seconds << " s ("
+              << static_cast<uint64_t>(stats.engine_seconds > 0 ? stats.messages / stats.engine_seconds : 0.0)
+              << " msg/s), Overall: "
+              << static_cast<uint64_t>(total > 0 ? stats.messages / total : 0.0) << " msg/s\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadConfig config;
+    uint64_t messages = 10000000;
+    size_t batch = 4096;
+    uint64_t seed = 0;
+    std::string journal_path;
+    bool generate_only = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--messages" && has_value) {
+            messages = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--symbols" && has_value) {
+            config.symbols = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--rate" && has_value) {
+            config.rate = std::atof(argv[++i]);
+        } else if (arg == "--hawkes" && has_value) {
+            config.arrivals = ArrivalProcess::HAWKES;
+            config.hawkes_branching = std::atof(argv[++i]);
+        } else if (arg == "--decay" && has_value) {
+            config.hawkes_decay = std::atof(argv[++i]);
+        } else if (arg == "--mix" && has_value) {
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf", &config.limit_weight, &config.market_weight,
+                            &config.cancel_weight) != 3) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "--batch-mode") {
+            config.mode = MatchingMode::BATCH;
+        } else if (arg == "--batch" && has_value) {
+            batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && has_value) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--journal" && has_value) {
+            journal_path = argv[++i];
+        } else if (arg == "--generate-only") {
+            generate_only = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    try {
+        LoadGenerator generator(config, seed);
+        std::cout << "Symbols: " << config.symbols
+                  << ", Arrivals: " << (config.arrivals == ArrivalProcess::HAWKES ? "hawkes" : "poisson")
+                  << ", Mode: " << (config.mode == MatchingMode::BATCH ? "batch" : "continuous") << "\n";
+
+        if (generate_only) {
+            std::vector<LoadMessage> buffer(std::max<size_t>(batch, 1));
+            LoadStats stats;
+            auto start = std::chrono::steady_clock::now();
+            while (stats.messages < messages) {
+                size_t count = static_cast<size_t>(std::min<uint64_t>(buffer.size(), messages - stats.messages));
+                generator.generate(buffer.data(), count);
+                for (size_t i = 0; i < count; i++) {
+                    (buffer[i].action == LoadAction::ORDER ? stats.orders : stats.cancels)++;
+                }
+                stats.messages += count;
+            }
+            stats.generate_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printRates(stats, "Engine");
+        } else if (!journal_path.empty()) {
+            JournalWriter journal(journal_path);
+            LoadStats stats = generator.writeJournal(journal, messages, batch);
+            printRates(stats, "Journal");
+            std::cout << "Journal: " << journal_path << ", Records: " << journal.recordCount() << "\n";
+        } else {
+            OrderBookManager manager;
+            generator.addBooks(manager);
+            LoadStats stats = generator.drive(manager, messages, batch);
+            printRates(stats, "Engine");
+            std::cout << "Trades: " << stats.trades
+                      << ", Rejects: " << stats.rejects
+                      << ", Missed Cancels: " << stats.cancels_missed
+                      << ", Simulated Seconds: " << generator.now() / 1e9 << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Load generation failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,7 +1,16 @@
 #include "OrderBook.hpp"
 #include "OrderBookManager.hpp"
+#include "NativeAgents.hpp"
+#include "Simulation.hpp"
+#include "Journal.hpp"
+#include "EngineStats.hpp"
+#include "LoadGenerator.hpp"
+#include "MarketData.hpp"
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 #include <vector>
 
 //-------------TESTING FILE---------- IGNORE
@@ -15,15 +24,23 @@ void printMarketData(const OrderBookManager& manager, const std::vector<std::str
     }
 }
 
-void printTrades(const std::vector<Trade>& trades) {
+//Orders are built from readable ids interned by the manager
+Order makeOrder(OrderBookManager& manager, const std::string& order_id, const std::string& client_id,
+                const std::string& symbol, Side side, double price, int quantity,
+                OrderType type = OrderType::LIMIT) {
+    return Order(manager.internOrderId(order_id), manager.internClientId(client_id),
+                 manager.getSymbolId(symbol), side, price, quantity, type);
+}
+
+void printTrades(const OrderBookManager& manager, const std::vector<Trade>& trades) {
     std::cout << "\nTrades:\n";
     for (const auto& trade : trades) {
-        std::cout << "Trade ID: " << trade.trade_id
-                  << ", Symbol: " << trade.symbol
+        std::cout << "Trade ID: " << formatTradeId(trade.trade_id, manager.getSymbolName(trade.symbol))
+                  << ", Symbol: " << manager.getSymbolName(trade.symbol)
                   << ", Price: " << trade.price
                   << ", Quantity: " << trade.quantity
-                  << ", Buy Order: " << trade.buy_order_id
-                  << ", Sell Order: " << trade.sell_order_id << "\n";
+                  << ", Buy Order: " << manager.getOrderIdName(trade.buy_order_id)
+                  << ", Sell Order: " << manager.getOrderIdName(trade.sell_order_id) << "\n";
     }
 }
 
@@ -58,12 +75,12 @@ int main() { //TESTS
 
         std::cout << "=== Test 1: Basic Order Matching ===\n";
         //First I'll create and place some basic orders
-        Order buy_order1("order1", "client1", "AAPL", Side::BUY, 100.0, 100);
-        Order sell_order1("order2", "client2", "AAPL", Side::SELL, 100.0, 50);
+        Order buy_order1 = makeOrder(manager, "order1", "client1", "AAPL", Side::BUY, 100.0, 100);
+        Order sell_order1 = makeOrder(manager, "order2", "client2", "AAPL", Side::SELL, 100.0, 50);
         manager.placeOrder(buy_order1);
         manager.placeOrder(sell_order1);
         std::vector<Trade> trades1 = manager.processOrders();
-        printTrades(trades1);
+        printTrades(manager, trades1);
         printMarketData(manager, symbols);
         printOrderBookDepth(manager, "AAPL");
 
@@ -75,17 +92,17 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 2: Multiple Price Levels ===\n";
         //Add orders at diff price levels
-        Order buy_order2("order3", "client3", "MSFT", Side::BUY, 200.0, 100);
-        Order buy_order3("order4", "client4", "MSFT", Side::BUY, 195.0, 50);
-        Order sell_order2("order5", "client5", "MSFT", Side::SELL, 205.0, 75);
-        Order sell_order3("order6", "client6", "MSFT", Side::SELL, 210.0, 25);
+        Order buy_order2 = makeOrder(manager, "order3", "client3", "MSFT", Side::BUY, 200.0, 100);
+        Order buy_order3 = makeOrder(manager, "order4", "client4", "MSFT", Side::BUY, 195.0, 50);
+        Order sell_order2 = makeOrder(manager, "order5", "client5", "MSFT", Side::SELL, 205.0, 75);
+        Order sell_order3 = makeOrder(manager, "order6", "client6", "MSFT", Side::SELL, 210.0, 25);
         
         manager.placeOrder(buy_order2);
         manager.placeOrder(buy_order3);
         manager.placeOrder(sell_order2);
         manager.placeOrder(sell_order3);
         std::vector<Trade> trades2 = manager.processOrders();
-        printTrades(trades2);
+        printTrades(manager, trades2);
         printMarketData(manager, symbols);
         printOrderBookDepth(manager, "MSFT");
 
@@ -97,8 +114,8 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 3: Market Buy Order Execution ===\n";
         //Now test market buy order execution
-        Order limit_sell1("order9", "client9", "GOOGL", Side::SELL, 150.0, 100);
-        Order market_buy1("order7", "client7", "GOOGL", Side::BUY, 0.0, 100, OrderType::MARKET);
+        Order limit_sell1 = makeOrder(manager, "order9", "client9", "GOOGL", Side::SELL, 150.0, 100);
+        Order market_buy1 = makeOrder(manager, "order7", "client7", "GOOGL", Side::BUY, 0.0, 100, OrderType::MARKET);
         
         //Place limit sell first to ensure liquidity (will change in true simulation to have initial liquidity)
         manager.placeOrder(limit_sell1);
@@ -106,7 +123,7 @@ int main() { //TESTS
         //Place and process market buy
         manager.placeOrder(market_buy1);
         std::vector<Trade> trades3 = manager.processOrders();
-        printTrades(trades3);
+        printTrades(manager, trades3);
         printMarketData(manager, symbols);
         printOrderBookDepth(manager, "GOOGL");
 
@@ -118,12 +135,12 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 3.1: Market Sell with No Liquidity ===\n";
         //Test market sell order with no liquidity -> Ensure errors function properly
-        Order market_sell1("order8", "client8", "GOOGL", Side::SELL, 0.0, 100, OrderType::MARKET);
+        Order market_sell1 = makeOrder(manager, "order8", "client8", "GOOGL", Side::SELL, 0.0, 100, OrderType::MARKET);
         
         try {
             manager.placeOrder(market_sell1);
             std::vector<Trade> trades3_1 = manager.processOrders();
-            printTrades(trades3_1);
+            printTrades(manager, trades3_1);
         } catch (const std::exception& e) {
             std::cout << "Expected error: " << e.what() << "\n";
         }
@@ -137,7 +154,7 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 4: Order Cancellation ===\n";
         //Now need to check cancellation mechanism
-        Order buy_order4("order10", "client10", "AAPL", Side::BUY, 105.0, 100);
+        Order buy_order4 = makeOrder(manager, "order10", "client10", "AAPL", Side::BUY, 105.0, 100);
         manager.placeOrder(buy_order4);
         printOrderBookDepth(manager, "AAPL");
         
@@ -165,7 +182,7 @@ int main() { //TESTS
 
         try {
             //Error checking pt2
-            Order invalid_order("order11", "client11", "INVALID", Side::BUY, 100.0, 100);
+            Order invalid_order = makeOrder(manager, "order11", "client11", "INVALID", Side::BUY, 100.0, 100);
             manager.placeOrder(invalid_order);
         } catch (const std::exception& e) {
             std::cout << "Expected error: " << e.what() << "\n";
@@ -178,12 +195,34 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 6: Price Validation ===\n";
         try {
-            Order invalid_price("order12", "client12", "AAPL", Side::BUY, -100.0, 100);
+            Order invalid_price = makeOrder(manager, "order12", "client12", "AAPL", Side::BUY, -100.0, 100);
             manager.placeOrder(invalid_price);
         } catch (const std::exception& e) {
             std::cout << "Expected error: " << e.what() << "\n";
         }
 
+        //Prices with no tick count: the constructor throws on non-finite ones, and orders
+        //built field by field are rejected by submitOrder and submitOrders without touching the book
+        for (double bad_price : {std::nan(""), std::numeric_limits<double>::infinity(), 1e30}) {
+            const char* error = Order::validate(OrderType::LIMIT, bad_price, 100);
+            Order bad_order;
+            bad_order.order_id = manager.internOrderId("order12a");
+            bad_order.client_id = manager.internClientId("client12");
+            bad_order.symbol = manager.getSymbolId("AAPL");
+            bad_order.side = Side::SELL;
+            bad_order.price = bad_price;
+            bad_order.quantity = 100;
+            bad_order.type = OrderType::LIMIT;
+            bad_order.tif = TimeInForce::GTC;
+            SubmitResult single = manager.submitOrder(bad_order);
+            SubmitResult batch;
+            manager.submitOrders(&bad_order, 1, &batch);
+            std::cout << "Price " << bad_price << " - Validate: " << (error ? error : "ok")
+                      << ", submitOrder rejected: " << (single.status == SubmitStatus::REJECTED)
+                      << ", submitOrders rejected: " << (batch.status == SubmitStatus::REJECTED) << "\n";
+        }
+        std::cout << "Best Ask after rejects: " << manager.getBestAsk("AAPL") << "\n";
+
         for (const auto& symbol : symbols) {
             manager.removeOrderBook(symbol);
             manager.addOrderBook(symbol);
@@ -191,7 +230,7 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 7: Quantity Validation ===\n";
         try {
-            Order invalid_quantity("order13", "client13", "AAPL", Side::BUY, 100.0, 0);
+            Order invalid_quantity = makeOrder(manager, "order13", "client13", "AAPL", Side::BUY, 100.0, 0);
             manager.placeOrder(invalid_quantity);
         } catch (const std::exception& e) {
             std::cout << "Expected error: " << e.what() << "\n";
@@ -205,11 +244,11 @@ int main() { //TESTS
         std::cout << "\n=== Test 8: Market Order Validation ===\n";
         try {
             //Limit sell order
-            Order limit_sell2("order14", "client14", "AAPL", Side::SELL, 100.0, 50);
+            Order limit_sell2 = makeOrder(manager, "order14", "client14", "AAPL", Side::SELL, 100.0, 50);
             manager.placeOrder(limit_sell2);
             
             //Place market buy order
-            Order invalid_market("order15", "client15", "AAPL", Side::BUY, 100.0, 50, OrderType::MARKET);
+            Order invalid_market = makeOrder(manager, "order15", "client15", "AAPL", Side::BUY, 100.0, 50, OrderType::MARKET);
             manager.placeOrder(invalid_market);
         } catch (const std::exception& e) {
             std::cout << "Expected error: " << e.what() << "\n";
@@ -222,15 +261,15 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 9: Market Order Execution ===\n";
         //Limit sell order pt2
-        Order limit_sell3("order16", "client16", "AAPL", Side::SELL, 100.0, 50);
+        Order limit_sell3 = makeOrder(manager, "order16", "client16", "AAPL", Side::SELL, 100.0, 50);
         manager.placeOrder(limit_sell3);
         
         //Matching market buy order
-        Order market_buy2("order17", "client17", "AAPL", Side::BUY, 0.0, 50, OrderType::MARKET);
+        Order market_buy2 = makeOrder(manager, "order17", "client17", "AAPL", Side::BUY, 0.0, 50, OrderType::MARKET);
         manager.placeOrder(market_buy2);
         
         std::vector<Trade> trades9 = manager.processOrders();
-        printTrades(trades9);
+        printTrades(manager, trades9);
         printMarketData(manager, symbols);
         printOrderBookDepth(manager, "AAPL");
 
@@ -241,15 +280,15 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 10: Partial Fills and Remaining Quantity ===\n";
         //Test out partial fills mechanism
-        Order large_buy("order18", "client18", "AAPL", Side::BUY, 100.0, 200);
-        Order small_sell1("order19", "client19", "AAPL", Side::SELL, 100.0, 50);
-        Order small_sell2("order20", "client20", "AAPL", Side::SELL, 100.0, 75);
+        Order large_buy = makeOrder(manager, "order18", "client18", "AAPL", Side::BUY, 100.0, 200);
+        Order small_sell1 = makeOrder(manager, "order19", "client19", "AAPL", Side::SELL, 100.0, 50);
+        Order small_sell2 = makeOrder(manager, "order20", "client20", "AAPL", Side::SELL, 100.0, 75);
         
         manager.placeOrder(large_buy);
         manager.placeOrder(small_sell1);
         manager.placeOrder(small_sell2);
         std::vector<Trade> trades10 = manager.processOrders();
-        printTrades(trades10);
+        printTrades(manager, trades10);
         printOrderBookDepth(manager, "AAPL");
 
         for (const auto& symbol : symbols) {
@@ -259,17 +298,17 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 11: Multiple Trades at Same Price Level ===\n";
         //Test at same price
-        Order buy1("order21", "client21", "MSFT", Side::BUY, 150.0, 100);
-        Order buy2("order22", "client22", "MSFT", Side::BUY, 150.0, 50);
-        Order sell1("order23", "client23", "MSFT", Side::SELL, 150.0, 75);
-        Order sell2("order24", "client24", "MSFT", Side::SELL, 150.0, 100);
+        Order buy1 = makeOrder(manager, "order21", "client21", "MSFT", Side::BUY, 150.0, 100);
+        Order buy2 = makeOrder(manager, "order22", "client22", "MSFT", Side::BUY, 150.0, 50);
+        Order sell1 = makeOrder(manager, "order23", "client23", "MSFT", Side::SELL, 150.0, 75);
+        Order sell2 = makeOrder(manager, "order24", "client24", "MSFT", Side::SELL, 150.0, 100);
         
         manager.placeOrder(buy1);
         manager.placeOrder(buy2);
         manager.placeOrder(sell1);
         manager.placeOrder(sell2);
         std::vector<Trade> trades11 = manager.processOrders();
-        printTrades(trades11);
+        printTrades(manager, trades11);
         printOrderBookDepth(manager, "MSFT");
 
         for (const auto& symbol : symbols) {
@@ -280,9 +319,9 @@ int main() { //TESTS
         std::cout << "\n=== Test 12: Order Book Depth with Many Levels ===\n";
         //Depth testing...
         for (int i = 0; i < 10; i++) {
-            Order buy("buy" + std::to_string(i), "client" + std::to_string(i), "GOOGL", 
+            Order buy = makeOrder(manager, "buy" + std::to_string(i), "client" + std::to_string(i), "GOOGL", 
                      Side::BUY, 100.0 + i, 100);
-            Order sell("sell" + std::to_string(i), "client" + std::to_string(i), "GOOGL", 
+            Order sell = makeOrder(manager, "sell" + std::to_string(i), "client" + std::to_string(i), "GOOGL", 
                       Side::SELL, 110.0 + i, 100);
             manager.placeOrder(buy);
             manager.placeOrder(sell);
@@ -296,12 +335,12 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 13: Order Lookup Functionality ===\n";
         //Order lookup mechanism
-        Order test_order("order25", "client25", "AAPL", Side::BUY, 100.0, 100);
+        Order test_order = makeOrder(manager, "order25", "client25", "AAPL", Side::BUY, 100.0, 100);
         manager.placeOrder(test_order);
         
         if (manager.hasOrder("AAPL", "order25")) {
             const Order* found_order = manager.getOrder("AAPL", "order25");
-            std::cout << "Found order: ID=" << found_order->order_id 
+            std::cout << "Found order: ID=" << manager.getOrderIdName(found_order->order_id)
                       << ", Price=" << found_order->price 
                       << ", Quantity=" << found_order->quantity << "\n";
         }
@@ -314,17 +353,17 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 14: Multi-Symbol Order Matching ===\n";
         //Test manager functionality with multi order matching
-        Order aapl_buy("order26", "client26", "AAPL", Side::BUY, 100.0, 100);
-        Order aapl_sell("order27", "client27", "AAPL", Side::SELL, 100.0, 100);
-        Order msft_buy("order28", "client28", "MSFT", Side::BUY, 200.0, 100);
-        Order msft_sell("order29", "client29", "MSFT", Side::SELL, 200.0, 100);
+        Order aapl_buy = makeOrder(manager, "order26", "client26", "AAPL", Side::BUY, 100.0, 100);
+        Order aapl_sell = makeOrder(manager, "order27", "client27", "AAPL", Side::SELL, 100.0, 100);
+        Order msft_buy = makeOrder(manager, "order28", "client28", "MSFT", Side::BUY, 200.0, 100);
+        Order msft_sell = makeOrder(manager, "order29", "client29", "MSFT", Side::SELL, 200.0, 100);
         
         manager.placeOrder(aapl_buy);
         manager.placeOrder(aapl_sell);
         manager.placeOrder(msft_buy);
         manager.placeOrder(msft_sell);
         std::vector<Trade> trades14 = manager.processOrders();
-        printTrades(trades14);
+        printTrades(manager, trades14);
         printMarketData(manager, symbols);
 
         for (const auto& symbol : symbols) {
@@ -334,17 +373,27 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 15: Market Order with No Liquidity ===\n";
         //Test when no matching orders -> Error checking
-        Order market_buy3("order30", "client30", "AAPL", Side::BUY, 0.0, 100, OrderType::MARKET);
+        Order market_buy3 = makeOrder(manager, "order30", "client30", "AAPL", Side::BUY, 0.0, 100, OrderType::MARKET);
         
         try {
             manager.placeOrder(market_buy3);
             std::vector<Trade> trades15 = manager.processOrders();
-            printTrades(trades15);
+            printTrades(manager, trades15);
         } catch (const std::exception& e) {
             std::cout << "Expected error: " << e.what() << "\n";
         }
         printOrderBookDepth(manager, "AAPL");
 
+        //Market-to-limit remainder with no room on the ladder at the touch it traded at: cancelled, not thrown
+        manager.placeOrder(makeOrder(manager, "order30a", "client30", "AAPL", Side::BUY, 1.0, 10));
+        manager.placeOrder(makeOrder(manager, "order30b", "client30", "AAPL", Side::SELL, 20000.0, 10));
+        SubmitResult result15 = manager.submitOrder(makeOrder(manager, "order30c", "client30", "AAPL", Side::BUY, 0.0, 30,
+                                                              OrderType::MARKET_TO_LIMIT));
+        std::cout << "Market-to-limit status: " << static_cast<int>(result15.status) << " (PARTIALLY_CANCELLED is "
+                  << static_cast<int>(SubmitStatus::PARTIALLY_CANCELLED) << "), Filled: " << result15.filled
+                  << ", Remaining: " << result15.remaining << "\n";
+        printTrades(manager, manager.processOrders());
+
         for (const auto& symbol : symbols) {
             manager.removeOrderBook(symbol);
             manager.addOrderBook(symbol);
@@ -352,14 +401,14 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 16: Order Book State Persistence ===\n";
         //Test between ops
-        Order buy3("order31", "client31", "AAPL", Side::BUY, 100.0, 100);
-        Order sell3("order32", "client32", "AAPL", Side::SELL, 100.0, 50);
+        Order buy3 = makeOrder(manager, "order31", "client31", "AAPL", Side::BUY, 100.0, 100);
+        Order sell3 = makeOrder(manager, "order32", "client32", "AAPL", Side::SELL, 100.0, 50);
         
         manager.placeOrder(buy3);
         printOrderBookDepth(manager, "AAPL");
         manager.placeOrder(sell3);
         std::vector<Trade> trades16 = manager.processOrders();
-        printTrades(trades16);
+        printTrades(manager, trades16);
         printOrderBookDepth(manager, "AAPL");
 
         for (const auto& symbol : symbols) {
@@ -369,17 +418,143 @@ int main() { //TESTS
 
         std::cout << "\n=== Test 17: Trade ID Uniqueness ===\n";
         //Ensure unique IDs
-        Order buy4("order33", "client33", "AAPL", Side::BUY, 100.0, 100);
-        Order sell4("order34", "client34", "AAPL", Side::SELL, 100.0, 100);
-        Order buy5("order35", "client35", "AAPL", Side::BUY, 100.0, 100);
-        Order sell5("order36", "client36", "AAPL", Side::SELL, 100.0, 100);
+        Order buy4 = makeOrder(manager, "order33", "client33", "AAPL", Side::BUY, 100.0, 100);
+        Order sell4 = makeOrder(manager, "order34", "client34", "AAPL", Side::SELL, 100.0, 100);
+        Order buy5 = makeOrder(manager, "order35", "client35", "AAPL", Side::BUY, 100.0, 100);
+        Order sell5 = makeOrder(manager, "order36", "client36", "AAPL", Side::SELL, 100.0, 100);
         
         manager.placeOrder(buy4);
         manager.placeOrder(sell4);
         manager.placeOrder(buy5);
         manager.placeOrder(sell5);
         std::vector<Trade> trades17 = manager.processOrders();
-        printTrades(trades17);
+        printTrades(manager, trades17);
+
+        for (const auto& symbol : symbols) {
+            manager.removeOrderBook(symbol);
+            manager.addOrderBook(symbol);
+        }
+
+        std::cout << "\n=== Test 18: Continuous Matching ===\n";
+        //Aggressor trades on arrival at the resting price, remainder rests
+        manager.setMatchingMode("AAPL", MatchingMode::CONTINUOUS);
+        manager.placeOrder(makeOrder(manager, "order37", "client37", "AAPL", Side::SELL, 100.0, 50));
+        manager.placeOrder(makeOrder(manager, "order38", "client38", "AAPL", Side::SELL, 100.5, 50));
+        manager.placeOrder(makeOrder(manager, "order39", "client39", "AAPL", Side::BUY, 101.0, 120));
+        printOrderBookDepth(manager, "AAPL");
+        std::vector<Trade> trades18 = manager.processOrders();
+        printTrades(manager, trades18);
+
+        std::cout << "\n=== Test 19: Native Simulation ===\n";
+        //The four native rule-based agents on AAPL against the fund's quotes
+        SimulationConfig sim_config;
+        sim_config.num_steps = 100;
+        sim_config.seed = 1;
+        sim_config.record_trades = true;
+        Simulation simulation(sim_config);
+        SymbolId sim_symbol = simulation.getSymbolId("AAPL");
+        simulation.addAgent("MM-0", sim_symbol, std::make_shared<MarketMakerAgent>());
+        simulation.addAgent("TF-0", sim_symbol, std::make_shared<TrendFollowerAgent>());
+        simulation.addAgent("MR-0", sim_symbol, std::make_shared<MeanReverterAgent>());
+        simulation.addAgent("LT-0", sim_symbol, std::make_shared<LiquidityTakerAgent>(0.5, 1, 5, 1));
+        simulation.run();
+        std::cout << "Steps: " << simulation.currentStep() << ", Trades: " << simulation.tradeCount() << "\n";
+        if (!simulation.trades().empty()) {
+            Trade first = simulation.trades().at(0);
+            std::cout << "Recorded: " << simulation.trades().size() << ", First: [step " << simulation.tradeSteps()[0]
+                      << "] " << first.quantity << "@" << first.price << "\n";
+        }
+        for (AgentId agent = 0; agent < simulation.agentCount(); agent++) {
+            const AgentAccount& account = simulation.getAccount(agent);
+            std::cout << account.name << " - Inventory: " << account.inventory << ", Trades: " << account.trades
+                      << ", P&L: " << account.pnl << "\n";
+        }
+
+        std::cout << "\n=== Test 20: Journal Replay ===\n";
+        //Journal a simulation from its first step, then replay it into a fresh manager
+        const char* journal_path = "orderbook_test.journal";
+        Simulation journalled(sim_config);
+        journalled.addAgent("MM-0", sim_symbol, std::make_shared<MarketMakerAgent>());
+        journalled.addAgent("LT-0", sim_symbol, std::make_shared<LiquidityTakerAgent>(0.5, 1, 5, 1));
+        journalled.getManager().setJournal(std::make_unique<JournalWriter>(journal_path));
+        journalled.run();
+        journalled.getManager().getJournal()->flush();
+        {
+            JournalReader journal(journal_path);
+            OrderBookManager replayed;
+            ReplayStats stats = replayJournal(journal, replayed);
+            std::cout << "Records: " << stats.records << ", Orders: " << stats.orders
+                      << ", Trades: " << stats.replay_trades << "/" << stats.journal_trades
+                      << ", Mismatched: " << stats.mismatched_trades << "\n";
+            std::cout << "Best Bid: " << replayed.getBestBid(sim_symbol) << " (" << journalled.getBestBid(sim_symbol)
+                      << "), Best Ask: " << replayed.getBestAsk(sim_symbol) << " (" << journalled.getBestAsk(sim_symbol) << ")\n";
+        }
+        journalled.getManager().setJournal(nullptr);
+        std::remove(journal_path);
+
+        std::cout << "\n=== Test 21: Snapshot Restore ===\n";
+        //Image the simulation's warmed-up books and bulk-load them into a fresh manager
+        std::vector<uint8_t> image;
+        journalled.getManager().saveSnapshot(image);
+        OrderBookManager restored;
+        restored.loadSnapshot(image.data(), image.size());
+        std::cout << "Image bytes: " << image.size() << "\n";
+        printOrderBookDepth(restored, "AAPL");
+        restored.placeOrder(makeOrder(restored, "order40", "client40", "AAPL", Side::BUY, 0.0, 3, OrderType::MARKET));
+        printTrades(restored, restored.processOrders());
+
+        std::cout << "\n=== Test 22: Forked Branch ===\n";
+        //A what-if market buy in a branch leaves the restored book as it was
+        std::unique_ptr<OrderBookManager> branch = restored.fork();
+        branch->placeOrder(makeOrder(*branch, "order41", "client41", "AAPL", Side::BUY, 0.0, 2, OrderType::MARKET));
+        printTrades(*branch, branch->processOrders());
+        std::cout << "Branch Best Ask: " << branch->getBestAsk("AAPL")
+                  << ", Parent Best Ask: " << restored.getBestAsk("AAPL") << "\n";
+
+        std::cout << "\n=== Test 23: Engine Stats ===\n";
+        //Totals over every test above; all zero unless built with ORDERBOOK_STATS
+        EngineStats stats = readEngineStats();
+        std::cout << "Stats Enabled: " << (stats.enabled ? "yes" : "no") << "\n";
+        for (size_t op = 0; op < stats.latency.size(); op++) {
+            std::cout << statsOpName(static_cast<StatsOp>(op)) << ": " << stats.latency[op].count << " calls\n";
+        }
+        std::cout << "Orders: " << stats[StatsCounter::ORDERS] << ", Trades: " << stats[StatsCounter::TRADES]
+                  << ", Rejects: " << stats[StatsCounter::REJECTS] << ", Peak Depth: " << stats.peak_depth << "\n";
+
+        std::cout << "\n=== Test 24: Load Generator ===\n";
+        //Seeded synthetic flow over three fresh books
+        LoadConfig load_config;
+        load_config.symbols = 3;
+        OrderBookManager loaded;
+        LoadGenerator generator(load_config, 42);
+        generator.addBooks(loaded);
+        LoadStats load = generator.drive(loaded, 10000, 500);
+        std::cout << "Messages: " << load.messages << ", Orders: " << load.orders << ", Cancels: " << load.cancels
+                  << ", Trades: " << load.trades << ", Missed Cancels: " << load.cancels_missed << "\n";
+        std::cout << "LOAD0 Best Bid: " << loaded.getBestBid("LOAD0") << ", Best Ask: " << loaded.getBestAsk("LOAD0") << "\n";
+
+        std::cout << "\n=== Test 25: Market Data Feed ===\n";
+        //Updates from a fresh continuous book: its CLEAR, two quotes, then a market buy that trades
+        OrderBookManager feed;
+        feed.addOrderBook("AAPL");
+        feed.setMatchingMode("AAPL", MatchingMode::CONTINUOUS);
+        const char* event_names[] = {"CLEAR", "LEVEL_ADD", "LEVEL_UPDATE", "LEVEL_DELETE", "TOP_OF_BOOK", "TRADE"};
+        MarketDataCallback print_update([&event_names](const MarketDataUpdate& update) {
+            std::cout << "#" << update.sequence << " " << event_names[static_cast<int>(update.event)];
+            if (update.event == MarketDataEvent::TOP_OF_BOOK) {
+                std::cout << " - Bid: " << update.quantity << " @ " << update.price
+                          << ", Ask: " << update.ask_quantity << " @ " << update.ask_price;
+            } else if (update.event != MarketDataEvent::CLEAR) {
+                std::cout << " - " << (update.side == Side::BUY ? "BUY" : "SELL")
+                          << " " << update.quantity << " @ " << update.price;
+            }
+            std::cout << "\n";
+        });
+        feed.setMarketDataSink(&print_update);
+        feed.placeOrder(makeOrder(feed, "order42", "client42", "AAPL", Side::BUY, 99.0, 10));
+        feed.placeOrder(makeOrder(feed, "order43", "client43", "AAPL", Side::SELL, 101.0, 5));
+        feed.placeOrder(makeOrder(feed, "order44", "client44", "AAPL", Side::BUY, 0.0, 3, OrderType::MARKET));
+        feed.setMarketDataSink(nullptr);
 
     } catch (const std::exception& e) {
         std::cerr << "Unexpected error: " << e.what() << "\n";
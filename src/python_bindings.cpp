@@ -1,17 +1,575 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 
 #include "Order.hpp"
 #include "Trade.hpp"
 #include "OrderBookManager.hpp"
+#include "Simulation.hpp"
+#include "NativeAgents.hpp"
+#include "MonteCarlo.hpp"
+#include "VecEnv.hpp"
+#include "EngineStats.hpp"
+#include "MarketData.hpp"
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <variant>
 
 namespace py = pybind11;
 
+//---------- Python-facing order/trade with readable string ids -------------
+//The engine runs on integer ids; strings are interned through the manager here.
+
+struct PyOrder {
+    std::string order_id;
+    std::string client_id;
+    std::string symbol;
+    Side side;
+    double price;
+    int quantity;
+    OrderType type;
+    TimeInForce tif;
+    uint64_t timestamp;
+
+    PyOrder(const std::string& order_id,
+            const std::string& client_id,
+            const std::string& symbol,
+            Side side,
+            double price,
+            int quantity,
+            OrderType type,
+            TimeInForce tif = TimeInForce::GTC)
+        : order_id(order_id),
+          client_id(client_id),
+          symbol(symbol),
+          side(side),
+          price(price),
+          quantity(quantity),
+          type(type),
+          tif(tif),
+          timestamp(0) {
+        Order(0, 0, 0, side, price, quantity, type, tif); //Engine ctor validates
+    }
+
+    Order toOrder(OrderBookManager& mgr) const {
+        return Order(mgr.internOrderId(order_id), mgr.internClientId(client_id),
+                     mgr.getSymbolId(symbol), side, price, quantity, type, tif);
+    }
+
+    static PyOrder fromOrder(const OrderBookManager& mgr, const Order& order) {
+        PyOrder named(mgr.getOrderIdName(order.order_id), mgr.getClientIdName(order.client_id),
+                      mgr.getSymbolName(order.symbol), order.side, order.price, order.quantity, order.type, order.tif);
+        named.timestamp = order.timestamp;
+        return named;
+    }
+};
+
+struct PyTrade {
+    TradeId trade_id;
+    std::string symbol;
+    double price;
+    int quantity;
+    std::string buy_order_id;
+    std::string sell_order_id;
+    std::string buyer_client_id;
+    std::string seller_client_id;
+    uint64_t timestamp;
+
+    static PyTrade fromTrade(const OrderBookManager& mgr, const Trade& trade) {
+        return PyTrade{trade.trade_id, mgr.getSymbolName(trade.symbol), trade.price, trade.quantity,
+                       mgr.getOrderIdName(trade.buy_order_id), mgr.getOrderIdName(trade.sell_order_id),
+                       mgr.getClientIdName(trade.buyer_client_id), mgr.getClientIdName(trade.seller_client_id),
+                       trade.timestamp};
+    }
+};
+
+//Order/cancel acknowledgement from async mode
+struct PyAck {
+    std::string order_id;
+    std::string symbol;
+    bool is_cancel;
+    SubmitResult result;
+
+    static PyAck fromEvent(const OrderBookManager& mgr, const EngineEvent& event) {
+        return PyAck{mgr.getOrderIdName(event.order_id), mgr.getSymbolName(event.symbol),
+                     event.type == EventType::CANCEL_ACK, event.result};
+    }
+};
+
+//---------- Sharing a manager between Python threads -------------
+//Each manager is guarded by its own mutex (OrderBookManager::apiMutex). To stay deadlock-free:
+// - nothing blocks on the mutex while holding the GIL (try first, drop the GIL to wait)
+// - engine-heavy calls run with the GIL released and the mutex held
+// - every read of manager state, name lookups included, holds the mutex: loading a
+//   snapshot or unsharing a forked book replaces the book table and interners with
+//   only the mutex held, so the GIL alone protects nothing
+//Independent managers share nothing, so threads driving different managers never contend.
+
+class ManagerLock {
+public:
+    explicit ManagerLock(const OrderBookManager& mgr) : lock_(mgr.apiMutex(), std::try_to_lock) {
+        if (!lock_.owns_lock()) {
+            py::gil_scoped_release release;
+            lock_.lock();
+        }
+    }
+
+private:
+    std::unique_lock<std::mutex> lock_;
+};
+
+//Runs fn with the GIL released and the manager locked; fn must not touch Python objects
+template <typename Fn>
+static decltype(auto) withoutGil(const OrderBookManager& mgr, Fn&& fn) {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(mgr.apiMutex());
+    return fn();
+}
+
+//Binds a manager method so every call holds the manager's lock. References are
+//copied before the lock is released, since the referenced state may then change.
+template <typename Ret, typename... Args>
+static auto locked(Ret (OrderBookManager::*method)(Args...)) {
+    return [method](OrderBookManager& mgr, Args... args) -> std::decay_t<Ret> {
+        ManagerLock lock(mgr);
+        return (mgr.*method)(std::forward<Args>(args)...);
+    };
+}
+
+template <typename Ret, typename... Args>
+static auto locked(Ret (OrderBookManager::*method)(Args...) const) {
+    return [method](const OrderBookManager& mgr, Args... args) -> std::decay_t<Ret> {
+        ManagerLock lock(mgr);
+        return (mgr.*method)(std::forward<Args>(args)...);
+    };
+}
+
+//---------- Batch submission from NumPy columns -------------
+//One crossing per batch: columns are read in place and orders go straight to the engine.
+//Ids in these columns are plain integers (below the interned-id bases), not strings.
+
+template <typename T>
+using Column = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+//A single book name for the whole batch, or one symbol id per row.
+//Unknown names map to id 0, which no book uses, so those rows come back REJECTED.
+static std::vector<SymbolId> symbolColumn(const OrderBookManager& mgr, const py::object& symbols, size_t rows) {
+    if (py::isinstance<py::str>(symbols)) {
+        std::string name = symbols.cast<std::string>();
+        ManagerLock lock(mgr);
+        return std::vector<SymbolId>(rows, mgr.hasOrderBook(name) ? mgr.getSymbolId(name) : 0);
+    }
+    Column<uint32_t> ids = symbols.cast<Column<uint32_t>>();
+    if (static_cast<size_t>(ids.size()) != rows) {
+        throw py::value_error("symbols must be a name or one id per row");
+    }
+    return std::vector<SymbolId>(ids.data(), ids.data() + rows);
+}
+
+static void requireRows(const py::array& column, size_t rows, const char* name) {
+    if (static_cast<size_t>(column.size()) != rows) {
+        throw py::value_error(std::string("column '") + name + "' has the wrong length");
+    }
+}
+
+static py::tuple placeOrderColumns(OrderBookManager& mgr,
+                                   const py::object& symbols,
+                                   const Column<uint64_t>& order_ids,
+                                   const Column<uint32_t>& client_ids,
+                                   const Column<uint8_t>& sides,
+                                   const Column<double>& prices,
+                                   const Column<int32_t>& quantities,
+                                   const std::optional<Column<uint8_t>>& types,
+                                   const std::optional<Column<uint8_t>>& tifs) {
+    size_t rows = static_cast<size_t>(order_ids.size());
+    requireRows(client_ids, rows, "client_ids");
+    requireRows(sides, rows, "sides");
+    requireRows(prices, rows, "prices");
+    requireRows(quantities, rows, "quantities");
+    if (types) requireRows(*types, rows, "types");
+    if (tifs) requireRows(*tifs, rows, "tifs");
+    std::vector<SymbolId> symbol_ids = symbolColumn(mgr, symbols, rows);
+
+    std::vector<Order> orders(rows);
+    for (size_t i = 0; i < rows; i++) {
+        Order& order = orders[i];
+        order.order_id = order_ids.data()[i];
+        order.client_id = client_ids.data()[i];
+        order.symbol = symbol_ids[i];
+        order.side = static_cast<Side>(sides.data()[i]);
+        order.price = prices.data()[i];
+        order.quantity = quantities.data()[i];
+        order.type = types ? static_cast<OrderType>(types->data()[i]) : OrderType::LIMIT;
+        order.tif = tifs ? static_cast<TimeInForce>(tifs->data()[i]) : TimeInForce::GTC;
+        order.timestamp = 0;
+
+        bool in_range = sides.data()[i] <= static_cast<uint8_t>(Side::SELL)
+                     && static_cast<uint8_t>(order.type) <= static_cast<uint8_t>(OrderType::MARKET_TO_LIMIT)
+                     && static_cast<uint8_t>(order.tif) <= static_cast<uint8_t>(TimeInForce::FOK)
+                     && order.order_id != 0 && order.order_id < OrderBookManager::INTERNED_ORDER_ID_BASE
+                     && order.client_id < OrderBookManager::INTERNED_CLIENT_ID_BASE;
+        if (!in_range) {
+            order.symbol = 0; //Routed to no book -> REJECTED
+        }
+    }
+
+    std::vector<SubmitResult> results(rows);
+    withoutGil(mgr, [&] { mgr.submitOrders(orders.data(), rows, results.data()); });
+
+    py::array_t<uint8_t> status(rows);
+    py::array_t<int32_t> filled(rows);
+    py::array_t<int32_t> remaining(rows);
+    for (size_t i = 0; i < rows; i++) {
+        status.mutable_data()[i] = static_cast<uint8_t>(results[i].status);
+        filled.mutable_data()[i] = results[i].filled;
+        remaining.mutable_data()[i] = results[i].remaining;
+    }
+    return py::make_tuple(status, filled, remaining);
+}
+
+//Structured-array form: fields order_id, client_id, side, price, quantity and optionally type, tif
+static py::tuple placeOrderRecords(OrderBookManager& mgr, const py::object& symbols, const py::array& records) {
+    py::object names = records.dtype().attr("names");
+    if (names.is_none()) {
+        throw py::value_error("orders must be a structured array");
+    }
+    auto has = [&names](const char* field) { return names.contains(py::str(field)); };
+    auto field = [&records](const char* name) { return records[py::str(name)]; };
+
+    std::optional<Column<uint8_t>> types, tifs;
+    if (has("type")) types = field("type").cast<Column<uint8_t>>();
+    if (has("tif")) tifs = field("tif").cast<Column<uint8_t>>();
+    return placeOrderColumns(mgr, symbols,
+                             field("order_id").cast<Column<uint64_t>>(),
+                             field("client_id").cast<Column<uint32_t>>(),
+                             field("side").cast<Column<uint8_t>>(),
+                             field("price").cast<Column<double>>(),
+                             field("quantity").cast<Column<int32_t>>(),
+                             types, tifs);
+}
+
+static py::array_t<bool> cancelOrderColumns(OrderBookManager& mgr, const py::object& symbols,
+                                            const Column<uint64_t>& order_ids) {
+    size_t rows = static_cast<size_t>(order_ids.size());
+    std::vector<SymbolId> symbol_ids = symbolColumn(mgr, symbols, rows);
+    py::array_t<bool> cancelled(rows);
+    bool* out = cancelled.mutable_data();
+    const OrderId* ids = order_ids.data();
+    withoutGil(mgr, [&] { mgr.tryCancelOrders(symbol_ids.data(), ids, rows, out); });
+    return cancelled;
+}
+
+//---------- Vectorised market snapshot -------------
+//snapshot() writes into arrays the caller allocated once (see snapshot_arrays), so a
+//step's market data for every symbol costs one crossing and no allocation.
+
+//Output arrays are written in place, so they must already have the exact dtype and layout
+template <typename T>
+static T* outputColumn(const py::dict& out, const char* name, size_t size) {
+    if (!out.contains(name)) {
+        return nullptr;
+    }
+    py::object column = out[name];
+    if (!py::isinstance<py::array_t<T, py::array::c_style>>(column)) {
+        throw py::type_error(std::string("snapshot array '") + name + "' must be C-contiguous "
+                             + py::str(py::dtype::of<T>()).cast<std::string>());
+    }
+    auto array = column.cast<py::array_t<T, py::array::c_style>>();
+    if (!array.writeable() || static_cast<size_t>(array.size()) != size) {
+        throw py::value_error(std::string("snapshot array '") + name + "' must be writeable with "
+                              + std::to_string(size) + " elements");
+    }
+    return array.mutable_data();
+}
+
+//A book name, a sequence of names, or an array of symbol ids. Unknown names throw.
+static std::vector<SymbolId> snapshotSymbols(const OrderBookManager& mgr, const py::object& symbols) {
+    bool single = py::isinstance<py::str>(symbols);
+    bool named = single;
+    if (!named && (py::isinstance<py::list>(symbols) || py::isinstance<py::tuple>(symbols))) {
+        py::sequence sequence = symbols;
+        named = sequence.size() == 0 || py::isinstance<py::str>(sequence[0]);
+    }
+    if (!named) {
+        Column<uint32_t> ids = symbols.cast<Column<uint32_t>>();
+        return std::vector<SymbolId>(ids.data(), ids.data() + ids.size());
+    }
+
+    std::vector<std::string> names = single ? std::vector<std::string>{symbols.cast<std::string>()}
+                                            : symbols.cast<std::vector<std::string>>();
+    std::vector<SymbolId> ids;
+    ids.reserve(names.size());
+    ManagerLock lock(mgr);
+    for (const std::string& name : names) {
+        ids.push_back(mgr.getSymbolId(name));
+    }
+    return ids;
+}
+
+static void snapshotInto(OrderBookManager& mgr, const py::object& symbols, int levels, const py::dict& out) {
+    std::vector<SymbolId> ids = snapshotSymbols(mgr, symbols);
+    size_t rows = ids.size();
+    size_t cells = rows * static_cast<size_t>(std::max(levels, 0));
+
+    MarketSnapshot columns;
+    columns.best_bid = outputColumn<double>(out, "best_bid", rows);
+    columns.best_ask = outputColumn<double>(out, "best_ask", rows);
+    columns.mid = outputColumn<double>(out, "mid", rows);
+    columns.spread = outputColumn<double>(out, "spread", rows);
+    columns.bid_size = outputColumn<int32_t>(out, "bid_size", rows);
+    columns.ask_size = outputColumn<int32_t>(out, "ask_size", rows);
+    columns.bid_prices = outputColumn<double>(out, "bid_prices", cells);
+    columns.bid_quantities = outputColumn<int32_t>(out, "bid_quantities", cells);
+    columns.ask_prices = outputColumn<double>(out, "ask_prices", cells);
+    columns.ask_quantities = outputColumn<int32_t>(out, "ask_quantities", cells);
+    if (!columns.bid_prices != !columns.bid_quantities || !columns.ask_prices != !columns.ask_quantities) {
+        throw py::value_error("snapshot depth needs both the prices and the quantities array of a side");
+    }
+
+    withoutGil(mgr, [&] { mgr.snapshot(ids.data(), rows, levels, columns); });
+}
+
+//Zeroed output arrays for snapshot(): top-of-book columns of length count,
+//depth columns shaped (count, levels)
+static py::dict snapshotArrays(size_t count, size_t levels) {
+    auto zeros = [](py::array array) {
+        array.attr("fill")(0);
+        return array;
+    };
+    py::dict out;
+    out["best_bid"] = zeros(py::array_t<double>(count));
+    out["best_ask"] = zeros(py::array_t<double>(count));
+    out["mid"] = zeros(py::array_t<double>(count));
+    out["spread"] = zeros(py::array_t<double>(count));
+    out["bid_size"] = zeros(py::array_t<int32_t>(count));
+    out["ask_size"] = zeros(py::array_t<int32_t>(count));
+    out["bid_prices"] = zeros(py::array_t<double>({count, levels}));
+    out["bid_quantities"] = zeros(py::array_t<int32_t>({count, levels}));
+    out["ask_prices"] = zeros(py::array_t<double>({count, levels}));
+    out["ask_quantities"] = zeros(py::array_t<int32_t>({count, levels}));
+    return out;
+}
+
+//---------- Zero-copy views of the trade tape -------------
+//Read-only NumPy arrays over a tape column; the tape object is the array's base,
+//so the view keeps it alive. process_orders_tape() hands Python its own copy of the
+//pass, so those views never change. A tape still owned by C++ (Simulation.trades())
+//never frees a column buffer while it lives (see TradeTape::grow): an old view of it
+//stays safe to read but may show rows written after it was taken.
+
+template <typename T>
+static py::array columnView(const py::object& owner, const std::vector<T>& column) {
+    py::array_t<T> view({column.size()}, {sizeof(T)}, column.data(), owner);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
+}
+
+//---------- Python agents -------------
+//Trampoline so Python classes can subclass Agent. The simulation runs with the
+//GIL released; the override takes it back for the duration of on_step.
+//market and orders are passed by reference and are only valid during the call.
+
+class PyAgent : public Agent {
+public:
+    using Agent::Agent;
+
+    void onStep(const MarketView& market, OrderSink& orders) override {
+        PYBIND11_OVERRIDE_PURE_NAME(void, Agent, "on_step", onStep, &market, &orders);
+    }
+};
+
+//---------- Native simulation results -------------
+//Copied out once at the end of a run, so plain NumPy arrays owning their data
+
+template <typename T>
+static py::array_t<T> historyArray(const std::vector<T>& values, size_t rows, size_t columns) {
+    py::array_t<T> array({rows, columns});
+    std::copy(values.begin(), values.end(), array.mutable_data());
+    return array;
+}
+
+static py::dict simulationAccounts(const Simulation& sim) {
+    size_t count = sim.agentCount();
+    py::list names, symbols;
+    py::array_t<double> pnl(count);
+    py::array_t<int64_t> inventory(count);
+    py::array_t<uint64_t> trades(count);
+    for (size_t i = 0; i < count; i++) {
+        const AgentAccount& account = sim.getAccount(static_cast<AgentId>(i));
+        names.append(account.name);
+        symbols.append(sim.getManager().getSymbolName(account.symbol));
+        pnl.mutable_data()[i] = account.pnl;
+        inventory.mutable_data()[i] = account.inventory;
+        trades.mutable_data()[i] = account.trades;
+    }
+    py::dict out;
+    out["name"] = names;
+    out["symbol"] = symbols;
+    out["pnl"] = pnl;
+    out["inventory"] = inventory;
+    out["trades"] = trades;
+    return out;
+}
+
+//Rows are recorded steps, columns are agents in the order they were added
+static py::dict simulationHistory(const Simulation& sim) {
+    const std::vector<uint64_t>& steps = sim.recordedSteps();
+    size_t rows = steps.size();
+    size_t agents = sim.agentCount();
+    py::dict out;
+    py::array_t<uint64_t> step(rows);
+    std::copy(steps.begin(), steps.end(), step.mutable_data());
+    out["step"] = step;
+    out["pnl"] = historyArray(sim.pnlHistory(), rows, agents);
+    out["inventory"] = historyArray(sim.inventoryHistory(), rows, agents);
+    out["nav"] = historyArray(sim.navHistory(), rows, agents);
+    return out;
+}
+
+//---------- Monte Carlo sweeps -------------
+
+template <typename T>
+static py::array_t<T> toArray(const std::vector<T>& values) {
+    py::array_t<T> array(values.size());
+    std::copy(values.begin(), values.end(), array.mutable_data());
+    return array;
+}
+
+//Every scenario once per seed across `threads` workers (0 = one per core), with the GIL
+//released for the whole sweep; one row per run, scenario-major
+static py::dict runMonteCarloSweep(const std::vector<Scenario>& scenarios,
+                                   const std::vector<uint64_t>& seeds,
+                                   size_t threads) {
+    MonteCarloResults results;
+    {
+        py::gil_scoped_release release;
+        ThreadPool pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+        results = runMonteCarlo(scenarios, seeds, pool);
+    }
+    py::dict out;
+    out["scenario"] = toArray(results.scenario);
+    out["seed"] = toArray(results.seed);
+    out["trades"] = toArray(results.trades);
+    out["orders_submitted"] = toArray(results.orders_submitted);
+    out["orders_rejected"] = toArray(results.orders_rejected);
+    out["market_maker_pnl"] = toArray(results.market_maker_pnl);
+    out["trend_follower_pnl"] = toArray(results.trend_follower_pnl);
+    out["mean_reverter_pnl"] = toArray(results.mean_reverter_pnl);
+    out["liquidity_taker_pnl"] = toArray(results.liquidity_taker_pnl);
+    out["gross_inventory"] = toArray(results.gross_inventory);
+    out["fundamental_drift"] = toArray(results.fundamental_drift);
+    return out;
+}
+
+//---------- Vectorised RL environments -------------
+//Observations, rewards and dones are read-only views of the VecEnv's own buffers
+//(the VecEnv is their base): no copies, but every reset()/step() overwrites them.
+//The buffers are sized once in the constructor and never reallocated, so old views
+//stay safe to read; copy them to keep a step's values.
+
+static py::tuple vecEnvOutputs(const py::object& owner) {
+    const VecEnv& env = owner.cast<const VecEnv&>();
+    py::array observations({env.size(), VecEnv::OBSERVATION_DIM}, env.observations().data(), owner);
+    py::array dones(py::dtype("bool"), {env.size()}, {sizeof(uint8_t)}, env.dones().data(), owner);
+    observations.attr("setflags")(py::arg("write") = false);
+    dones.attr("setflags")(py::arg("write") = false);
+    return py::make_tuple(observations, columnView(owner, env.rewards()), dones);
+}
+
+static void requireEnvRows(const VecEnv& env, const py::array& column, const char* name) {
+    if (static_cast<size_t>(column.size()) != env.size()) {
+        throw py::value_error(std::string(name) + " needs one entry per environment");
+    }
+}
+
+//---------- Incremental market data -------------
+//Drained updates are copied into NumPy columns owned by the caller, one row per update
+//in arrival order. Draining takes only the GIL: the ring has one consumer and the
+//engine never waits on it.
+
+static py::dict drainMarketData(MarketDataRing& ring, size_t max_updates) {
+    std::vector<MarketDataUpdate> updates(std::min(max_updates, ring.capacity()));
+    size_t count = ring.drain(updates.data(), updates.size());
+
+    py::array_t<uint64_t> sequence(count), timestamp(count), trade_id(count);
+    py::array_t<uint32_t> symbol(count);
+    py::array_t<uint8_t> event(count), side(count);
+    py::array_t<int32_t> orders(count);
+    py::array_t<double> price(count), ask_price(count);
+    py::array_t<int64_t> quantity(count), ask_quantity(count);
+    for (size_t i = 0; i < count; i++) {
+        const MarketDataUpdate& update = updates[i];
+        sequence.mutable_at(i) = update.sequence;
+        timestamp.mutable_at(i) = update.timestamp;
+        symbol.mutable_at(i) = update.symbol;
+        event.mutable_at(i) = static_cast<uint8_t>(update.event);
+        side.mutable_at(i) = static_cast<uint8_t>(update.side);
+        orders.mutable_at(i) = update.orders;
+        price.mutable_at(i) = update.price;
+        quantity.mutable_at(i) = update.quantity;
+        ask_price.mutable_at(i) = update.ask_price;
+        ask_quantity.mutable_at(i) = update.ask_quantity;
+        trade_id.mutable_at(i) = update.trade_id;
+    }
+
+    py::dict out;
+    out["sequence"] = sequence;
+    out["timestamp"] = timestamp;
+    out["symbol"] = symbol;
+    out["event"] = event; //MarketDataEvent values
+    out["side"] = side;   //Side values
+    out["orders"] = orders;
+    out["price"] = price;
+    out["quantity"] = quantity;
+    out["ask_price"] = ask_price;
+    out["ask_quantity"] = ask_quantity;
+    out["trade_id"] = trade_id;
+    return out;
+}
+
+//---------- Engine statistics -------------
+//Process-wide: every book on every thread records into the same totals
+
+static py::dict engineStats() {
+    EngineStats stats = readEngineStats();
+    py::dict out;
+    out["enabled"] = stats.enabled;
+    py::dict latency;
+    for (size_t op = 0; op < stats.latency.size(); op++) {
+        const LatencySummary& summary = stats.latency[op];
+        py::dict row;
+        row["count"] = summary.count;
+        row["mean_ns"] = summary.mean_ns;
+        row["p50_ns"] = summary.p50_ns;
+        row["p90_ns"] = summary.p90_ns;
+        row["p99_ns"] = summary.p99_ns;
+        row["p999_ns"] = summary.p999_ns;
+        row["max_ns"] = summary.max_ns;
+        latency[statsOpName(static_cast<StatsOp>(op))] = row;
+    }
+    out["latency"] = latency;
+    for (size_t counter = 0; counter < stats.counters.size(); counter++) {
+        out[statsCounterName(static_cast<StatsCounter>(counter))] = stats.counters[counter];
+    }
+    out["peak_depth"] = stats.peak_depth;
+    return out;
+}
+
 //---------- PYBIND11 TO CREATE CPP PYTHON INTERACTION -------------
 
 PYBIND11_MODULE(orderbook, m) {
     m.doc() = "Python bindings for the C++ OrderBook engine";
 
+    m.def("snapshot_arrays", &snapshotArrays, py::arg("count"), py::arg("levels") = 0,
+          "Preallocated output arrays for OrderBookManager.snapshot");
+    m.def("get_stats", &engineStats,
+          "Engine latency percentiles and counters; 'enabled' is False unless built with ORDERBOOK_STATS");
+    m.def("reset_stats", &resetEngineStats, "Zero the engine latency histograms and counters");
+
     //Cpp Enums
     py::enum_<Side>(m, "Side")
         .value("BUY", Side::BUY)
@@ -21,62 +579,474 @@ PYBIND11_MODULE(orderbook, m) {
     py::enum_<OrderType>(m, "OrderType")
         .value("LIMIT", OrderType::LIMIT)
         .value("MARKET", OrderType::MARKET)
+        .value("MARKET_TO_LIMIT", OrderType::MARKET_TO_LIMIT)
+        .export_values();
+
+    py::enum_<TimeInForce>(m, "TimeInForce")
+        .value("GTC", TimeInForce::GTC)
+        .value("IOC", TimeInForce::IOC)
+        .value("FOK", TimeInForce::FOK)
+        .export_values();
+
+    py::enum_<MatchingMode>(m, "MatchingMode")
+        .value("BATCH", MatchingMode::BATCH)
+        .value("CONTINUOUS", MatchingMode::CONTINUOUS)
         .export_values();
 
-    //Bind the 7-arg constructor... (No timestamp)
-    py::class_<Order>(m, "Order")
+    py::enum_<Partition>(m, "Partition")
+        .value("STATIC", Partition::STATIC)
+        .value("DYNAMIC", Partition::DYNAMIC)
+        .export_values();
+
+    py::enum_<SubmitStatus>(m, "SubmitStatus")
+        .value("RESTING", SubmitStatus::RESTING)
+        .value("PARTIALLY_FILLED", SubmitStatus::PARTIALLY_FILLED)
+        .value("FILLED", SubmitStatus::FILLED)
+        .value("PARTIALLY_CANCELLED", SubmitStatus::PARTIALLY_CANCELLED)
+        .value("CANCELLED", SubmitStatus::CANCELLED)
+        .value("REJECTED", SubmitStatus::REJECTED)
+        .export_values();
+
+    py::enum_<MarketDataEvent>(m, "MarketDataEvent")
+        .value("CLEAR", MarketDataEvent::CLEAR)
+        .value("LEVEL_ADD", MarketDataEvent::LEVEL_ADD)
+        .value("LEVEL_UPDATE", MarketDataEvent::LEVEL_UPDATE)
+        .value("LEVEL_DELETE", MarketDataEvent::LEVEL_DELETE)
+        .value("TOP_OF_BOOK", MarketDataEvent::TOP_OF_BOOK)
+        .value("TRADE", MarketDataEvent::TRADE)
+        .export_values();
+
+    //Result of submit_order... (plain values, no exceptions for market conditions)
+    py::class_<SubmitResult>(m, "SubmitResult")
+        .def_readonly("status", &SubmitResult::status)
+        .def_readonly("filled", &SubmitResult::filled)
+        .def_readonly("remaining", &SubmitResult::remaining)
+        .def("__repr__", [](const SubmitResult& r) {
+            return "<SubmitResult status=" + std::to_string(static_cast<int>(r.status))
+                 + " filled=" + std::to_string(r.filled)
+                 + " remaining=" + std::to_string(r.remaining) + ">";
+        })
+        ;
+
+    //Bind the 8-arg constructor... (No timestamp, tif defaults to GTC)
+    py::class_<PyOrder>(m, "Order")
         .def(py::init<const std::string&,
                       const std::string&,
                       const std::string&,
                       Side,
                       double,
                       int,
-                      OrderType>(),
+                      OrderType,
+                      TimeInForce>(),
              py::arg("order_id"),
              py::arg("client_id"),
              py::arg("symbol"),
              py::arg("side"),
              py::arg("price"),
              py::arg("quantity"),
-             py::arg("type"))
-        .def_readwrite("order_id", &Order::order_id)
-        .def_readwrite("client_id", &Order::client_id)
-        .def_readwrite("symbol", &Order::symbol)
-        .def_readwrite("side", &Order::side)
-        .def_readwrite("type", &Order::type)
-        .def_readwrite("price", &Order::price)
-        .def_readwrite("quantity", &Order::quantity)
-        .def_readwrite("timestamp", &Order::timestamp)  //timestamp is public but not in ctor
+             py::arg("type"),
+             py::arg("tif") = TimeInForce::GTC)
+        .def_readwrite("order_id", &PyOrder::order_id)
+        .def_readwrite("client_id", &PyOrder::client_id)
+        .def_readwrite("symbol", &PyOrder::symbol)
+        .def_readwrite("side", &PyOrder::side)
+        .def_readwrite("type", &PyOrder::type)
+        .def_readwrite("tif", &PyOrder::tif)
+        .def_readwrite("price", &PyOrder::price)
+        .def_readwrite("quantity", &PyOrder::quantity)
+        .def_readwrite("timestamp", &PyOrder::timestamp)  //timestamp is public but not in ctor
+        ;
+
+    //Trade... (ids resolved back to strings by process_orders)
+    py::class_<PyTrade>(m, "Trade")
+        .def_property_readonly("trade_id", [](const PyTrade& t) { return formatTradeId(t.trade_id, t.symbol); })
+        .def_property_readonly("trade_seq", [](const PyTrade& t) { return tradeIdSequence(t.trade_id); })
+        .def_readonly("symbol", &PyTrade::symbol)
+        .def_readonly("price", &PyTrade::price)
+        .def_readonly("quantity", &PyTrade::quantity)
+        .def_readonly("buy_order_id", &PyTrade::buy_order_id)
+        .def_readonly("sell_order_id", &PyTrade::sell_order_id)
+        .def_readonly("buyer_client_id", &PyTrade::buyer_client_id)
+        .def_readonly("seller_client_id", &PyTrade::seller_client_id)
+        .def_readonly("timestamp", &PyTrade::timestamp)
+        ;
+
+    //Async acks... (trades from poll_events come back as Trade)
+    py::class_<PyAck>(m, "Ack")
+        .def_readonly("order_id", &PyAck::order_id)
+        .def_readonly("symbol", &PyAck::symbol)
+        .def_readonly("is_cancel", &PyAck::is_cancel)
+        .def_property_readonly("status", [](const PyAck& a) { return a.result.status; })
+        .def_property_readonly("filled", [](const PyAck& a) { return a.result.filled; })
+        .def_property_readonly("remaining", [](const PyAck& a) { return a.result.remaining; })
+        ;
+
+    //Market data subscription... (see OrderBookManager.subscribe_market_data)
+    py::class_<MarketDataRing>(m, "MarketDataRing")
+        .def("drain", &drainMarketData, py::arg("max_updates") = 1 << 16,
+             "Pop pending updates as a dict of NumPy columns (event holds MarketDataEvent values)")
+        .def_property_readonly("dropped", &MarketDataRing::dropped)
+        .def_property_readonly("capacity", &MarketDataRing::capacity)
         ;
 
-    //Trade... (unchanged)
-    py::class_<Trade>(m, "Trade")
-        .def_readonly("trade_id", &Trade::trade_id)
-        .def_readonly("symbol", &Trade::symbol)
-        .def_readonly("price", &Trade::price)
-        .def_readonly("quantity", &Trade::quantity)
-        .def_readonly("buy_order_id", &Trade::buy_order_id)
-        .def_readonly("sell_order_id", &Trade::sell_order_id)
-        .def_readonly("timestamp", &Trade::timestamp)
+    //Trade tape... (columns as NumPy views, integer ids; names via get_*_name)
+    py::class_<TradeTape>(m, "TradeTape")
+        .def("__len__", &TradeTape::size)
+        .def_property_readonly("symbol",           [](py::object t) { return columnView(t, t.cast<const TradeTape&>().symbols()); })
+        .def_property_readonly("sequence",         [](py::object t) { return columnView(t, t.cast<const TradeTape&>().sequences()); })
+        .def_property_readonly("price",            [](py::object t) { return columnView(t, t.cast<const TradeTape&>().prices()); })
+        .def_property_readonly("quantity",         [](py::object t) { return columnView(t, t.cast<const TradeTape&>().quantities()); })
+        .def_property_readonly("buy_order_id",     [](py::object t) { return columnView(t, t.cast<const TradeTape&>().buyOrderIds()); })
+        .def_property_readonly("sell_order_id",    [](py::object t) { return columnView(t, t.cast<const TradeTape&>().sellOrderIds()); })
+        .def_property_readonly("buyer_client_id",  [](py::object t) { return columnView(t, t.cast<const TradeTape&>().buyerClientIds()); })
+        .def_property_readonly("seller_client_id", [](py::object t) { return columnView(t, t.cast<const TradeTape&>().sellerClientIds()); })
+        .def_property_readonly("timestamp",        [](py::object t) { return columnView(t, t.cast<const TradeTape&>().timestamps()); })
         ;
 
-    //Manager... (unchanged)
+    //Allocation counters... (flattened for soak-run logging)
+    py::class_<OrderBook::AllocationStats>(m, "AllocationStats")
+        .def_property_readonly("slab_allocations", [](const OrderBook::AllocationStats& s) { return s.pool.slab_allocations; })
+        .def_property_readonly("nodes_acquired",   [](const OrderBook::AllocationStats& s) { return s.pool.acquired; })
+        .def_property_readonly("nodes_released",   [](const OrderBook::AllocationStats& s) { return s.pool.released; })
+        .def_property_readonly("node_capacity",    [](const OrderBook::AllocationStats& s) { return s.pool.capacity; })
+        .def_property_readonly("nodes_in_use",     [](const OrderBook::AllocationStats& s) { return s.pool.in_use; })
+        .def_readonly("index_rehashes", &OrderBook::AllocationStats::index_rehashes)
+        ;
+
+    //Manager... (symbol and order ids are strings on this side)
+    using BookQuery = double (OrderBookManager::*)(const std::string&) const;
+    using SizeQuery = int (OrderBookManager::*)(const std::string&) const;
+    using DepthQuery = std::vector<std::pair<double, int>> (OrderBookManager::*)(const std::string&, int) const;
+
     py::class_<OrderBookManager>(m, "OrderBookManager")
         .def(py::init<>())
-        .def("add_order_book",    &OrderBookManager::addOrderBook,    py::arg("symbol"))
-        .def("remove_order_book", &OrderBookManager::removeOrderBook, py::arg("symbol"))
-        .def("has_order_book",    &OrderBookManager::hasOrderBook,    py::arg("symbol"))
-        .def("place_order",       &OrderBookManager::placeOrder,       py::arg("order"))
-        .def("cancel_order",      &OrderBookManager::cancelOrder,      py::arg("symbol"), py::arg("order_id"))
-        .def("process_orders",    &OrderBookManager::processOrders)
-        .def("get_best_bid",      &OrderBookManager::getBestBid,       py::arg("symbol"))
-        .def("get_best_ask",      &OrderBookManager::getBestAsk,       py::arg("symbol"))
-        .def("get_bid_size",      &OrderBookManager::getBidSize,       py::arg("symbol"))
-        .def("get_ask_size",      &OrderBookManager::getAskSize,       py::arg("symbol"))
-        .def("get_bid_depth",     &OrderBookManager::getBidDepth,      py::arg("symbol"), py::arg("levels"))
-        .def("get_ask_depth",     &OrderBookManager::getAskDepth,      py::arg("symbol"), py::arg("levels"))
-        .def("has_order",         &OrderBookManager::hasOrder,         py::arg("symbol"), py::arg("order_id"))
-        .def("get_order",         &OrderBookManager::getOrder,         py::arg("symbol"), py::arg("order_id"),
-             py::return_value_policy::reference_internal)
+        .def("add_order_book",    locked(&OrderBookManager::addOrderBook),    py::arg("symbol"), py::arg("tick_size") = 0.01)
+        .def("remove_order_book", locked(&OrderBookManager::removeOrderBook), py::arg("symbol"))
+        .def("has_order_book",    locked(&OrderBookManager::hasOrderBook),    py::arg("symbol"))
+        .def("place_order",       [](OrderBookManager& mgr, const PyOrder& order) {
+                                      ManagerLock lock(mgr);
+                                      mgr.placeOrder(order.toOrder(mgr));
+                                  }, py::arg("order"))
+        .def("submit_order",      [](OrderBookManager& mgr, const PyOrder& order) {
+                                      ManagerLock lock(mgr);
+                                      if (!mgr.hasOrderBook(order.symbol)) {
+                                          return SubmitResult{SubmitStatus::REJECTED, 0, order.quantity};
+                                      }
+                                      return mgr.submitOrder(order.toOrder(mgr));
+                                  }, py::arg("order"))
+        .def("place_orders",      &placeOrderColumns,
+             py::arg("symbols"), py::arg("order_ids"), py::arg("client_ids"), py::arg("sides"),
+             py::arg("prices"), py::arg("quantities"), py::arg("types") = py::none(), py::arg("tifs") = py::none(),
+             "Submit a batch of orders from columns; returns (status, filled, remaining) arrays")
+        .def("place_orders",      &placeOrderRecords, py::arg("symbols"), py::arg("orders"),
+             "Submit a batch of orders from a structured array; returns (status, filled, remaining) arrays")
+        .def("cancel_orders",     &cancelOrderColumns, py::arg("symbols"), py::arg("order_ids"),
+             "Cancel a batch of orders; returns a bool array, False where the order was not resting")
+        .def("get_symbol_id",     locked(&OrderBookManager::getSymbolId), py::arg("symbol"))
+        .def("try_cancel_order",  locked(py::overload_cast<const std::string&, const std::string&>(&OrderBookManager::tryCancelOrder)),
+             py::arg("symbol"), py::arg("order_id"))
+        .def("cancel_order",      locked(py::overload_cast<const std::string&, const std::string&>(&OrderBookManager::cancelOrder)),
+             py::arg("symbol"), py::arg("order_id"))
+        .def("process_orders",    [](OrderBookManager& mgr) {
+                                      //Names are resolved under the same lock as the match
+                                      return withoutGil(mgr, [&mgr] {
+                                          std::vector<Trade> trades = mgr.processOrders();
+                                          std::vector<PyTrade> named;
+                                          named.reserve(trades.size());
+                                          for (const Trade& trade : trades) {
+                                              named.push_back(PyTrade::fromTrade(mgr, trade));
+                                          }
+                                          return named;
+                                      });
+                                  })
+        .def("process_orders_tape", [](OrderBookManager& mgr) {
+                                      //Copied under the mutex: the manager rewrites its tape on the next pass,
+                                      //possibly from another thread, so Python never reads it directly
+                                      return withoutGil(mgr, [&mgr]() -> TradeTape { return mgr.processOrdersToTape(); });
+                                  },
+             "Match all books; this pass's trades as a TradeTape of their own")
+        .def("get_symbol_name",   locked(&OrderBookManager::getSymbolName), py::arg("symbol_id"))
+        .def("get_order_id_name", locked(&OrderBookManager::getOrderIdName), py::arg("order_id"))
+        .def("get_client_id_name", locked(&OrderBookManager::getClientIdName), py::arg("client_id"))
+        .def("intern_client_id",  locked(&OrderBookManager::internClientId), py::arg("client_id"))
+        .def("set_worker_threads", locked(&OrderBookManager::setWorkerThreads),
+             py::arg("workers"), py::arg("partition") = Partition::STATIC, py::arg("pin_threads") = false)
+        .def("get_worker_threads", locked(&OrderBookManager::getWorkerThreads))
+        .def("start_async",       locked(&OrderBookManager::startAsync),
+             py::arg("shards"), py::arg("queue_capacity") = 1 << 16, py::arg("pin_threads") = false)
+        .def("stop_async",        [](OrderBookManager& mgr) { withoutGil(mgr, [&mgr] { mgr.stopAsync(); }); })
+        .def("is_async",          locked(&OrderBookManager::isAsync))
+        .def("open_journal",      [](OrderBookManager& mgr, const std::string& path, size_t batch_records) {
+                                      ManagerLock lock(mgr);
+                                      mgr.setJournal(std::make_unique<JournalWriter>(path, batch_records));
+                                  }, py::arg("path"), py::arg("batch_records") = 1 << 16,
+             "Journal every accepted order, cancel and trade to a binary file (replay with journal_replay)")
+        .def("close_journal",     [](OrderBookManager& mgr) { withoutGil(mgr, [&mgr] { mgr.setJournal(nullptr); }); })
+        //The manager keeps the returned ring alive; a new subscription replaces the old one
+        .def("subscribe_market_data", [](OrderBookManager& mgr, size_t capacity) {
+                                      auto ring = std::make_unique<MarketDataRing>(capacity);
+                                      MarketDataSink* sink = ring.get();
+                                      withoutGil(mgr, [&] { mgr.setMarketDataSink(sink); });
+                                      return ring;
+                                  }, py::arg("capacity") = 1 << 16, py::keep_alive<1, 0>(),
+             "Push level, top-of-book and trade updates from every book into a ring; starts with each book's levels")
+        .def("unsubscribe_market_data", [](OrderBookManager& mgr) {
+                                      withoutGil(mgr, [&mgr] { mgr.setMarketDataSink(nullptr); });
+                                  })
+        .def("fork",              [](OrderBookManager& mgr) {
+                                      ManagerLock lock(mgr);
+                                      return mgr.fork();
+                                  }, "Independent what-if copy sharing unchanged books with this manager")
+        .def("save_snapshot",     [](OrderBookManager& mgr, const std::string& path) {
+                                      withoutGil(mgr, [&] { mgr.saveSnapshot(path); });
+                                  }, py::arg("path"), "Write every book, queue and interned id to a binary image file")
+        .def("load_snapshot",     [](OrderBookManager& mgr, const std::string& path) {
+                                      withoutGil(mgr, [&] { mgr.loadSnapshot(path); });
+                                  }, py::arg("path"), "Replace all books and ids with a saved image")
+        .def("snapshot_image",    [](OrderBookManager& mgr) {
+                                      std::vector<uint8_t> image;
+                                      withoutGil(mgr, [&] { mgr.saveSnapshot(image); });
+                                      return py::bytes(reinterpret_cast<const char*>(image.data()), image.size());
+                                  }, "The save_snapshot image as bytes, for warm-starting many managers in memory")
+        .def("load_snapshot_image", [](OrderBookManager& mgr, const py::bytes& image) {
+                                      std::string_view data = image;
+                                      withoutGil(mgr, [&] {
+                                          mgr.loadSnapshot(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+                                      });
+                                  }, py::arg("image"))
+        .def("post_order",        [](OrderBookManager& mgr, const PyOrder& order) {
+                                      ManagerLock lock(mgr);
+                                      return mgr.postOrder(order.toOrder(mgr));
+                                  }, py::arg("order"))
+        .def("post_cancel",       [](OrderBookManager& mgr, const std::string& symbol, const std::string& order_id) {
+                                      ManagerLock lock(mgr);
+                                      return mgr.postCancel(mgr.getSymbolId(symbol), mgr.internOrderId(order_id));
+                                  }, py::arg("symbol"), py::arg("order_id"))
+        .def("poll_events",       [](OrderBookManager& mgr, size_t max_events) {
+                                      return withoutGil(mgr, [&] {
+                                          std::vector<EngineEvent> events;
+                                          mgr.pollEvents(events, max_events);
+                                          std::vector<std::variant<PyTrade, PyAck>> polled;
+                                          polled.reserve(events.size());
+                                          for (const EngineEvent& event : events) {
+                                              if (event.type == EventType::TRADE) {
+                                                  polled.emplace_back(PyTrade::fromTrade(mgr, event.trade));
+                                              } else {
+                                                  polled.emplace_back(PyAck::fromEvent(mgr, event));
+                                              }
+                                          }
+                                          return polled;
+                                      });
+                                  }, py::arg("max_events") = SIZE_MAX)
+        .def("set_matching_mode", locked(py::overload_cast<const std::string&, MatchingMode>(&OrderBookManager::setMatchingMode)),
+             py::arg("symbol"), py::arg("mode"))
+        .def("get_matching_mode", locked(py::overload_cast<const std::string&>(&OrderBookManager::getMatchingMode, py::const_)),
+             py::arg("symbol"))
+        .def("get_best_bid",      locked(static_cast<BookQuery>(&OrderBookManager::getBestBid)), py::arg("symbol"))
+        .def("get_best_ask",      locked(static_cast<BookQuery>(&OrderBookManager::getBestAsk)), py::arg("symbol"))
+        .def("use_simulated_clock", [](OrderBookManager& mgr, double start_seconds) {
+                                      ManagerLock lock(mgr);
+                                      auto clock = std::make_unique<SimulatedClock>();
+                                      clock->setSeconds(start_seconds);
+                                      mgr.setClock(std::move(clock));
+                                  }, py::arg("start_seconds") = 0.0)
+        .def("use_steady_clock",  [](OrderBookManager& mgr) {
+                                      ManagerLock lock(mgr);
+                                      mgr.setClock(std::make_unique<SteadyClock>());
+                                  })
+        .def("use_batch_clock",   [](OrderBookManager& mgr) {
+                                      ManagerLock lock(mgr);
+                                      mgr.setClock(std::make_unique<BatchClock>());
+                                  })
+        .def("set_time",          locked(&OrderBookManager::setSimulationTime), py::arg("seconds"))
+        .def("now",               [](OrderBookManager& mgr) {
+                                      ManagerLock lock(mgr);
+                                      return mgr.getClock().now();
+                                  })
+        .def("get_tick_size",     locked(&OrderBookManager::getTickSize),      py::arg("symbol"))
+        .def("get_bid_size",      locked(static_cast<SizeQuery>(&OrderBookManager::getBidSize)), py::arg("symbol"))
+        .def("get_ask_size",      locked(static_cast<SizeQuery>(&OrderBookManager::getAskSize)), py::arg("symbol"))
+        .def("get_bid_depth",     locked(static_cast<DepthQuery>(&OrderBookManager::getBidDepth)), py::arg("symbol"), py::arg("levels"))
+        .def("get_ask_depth",     locked(static_cast<DepthQuery>(&OrderBookManager::getAskDepth)), py::arg("symbol"), py::arg("levels"))
+        .def("snapshot",          &snapshotInto, py::arg("symbols"), py::arg("levels"), py::arg("out"),
+             "Write top of book, sizes and depth for many symbols into the arrays in `out` (see snapshot_arrays)")
+        .def("get_allocation_stats", locked(&OrderBookManager::getAllocationStats), py::arg("symbol"))
+        .def("has_order",         locked(py::overload_cast<const std::string&, const std::string&>(&OrderBookManager::hasOrder, py::const_)),
+             py::arg("symbol"), py::arg("order_id"))
+        .def("get_order",         [](const OrderBookManager& mgr, const std::string& symbol, const std::string& order_id)
+                                      -> std::optional<PyOrder> {
+                                      ManagerLock lock(mgr);
+                                      const Order* order = mgr.getOrder(symbol, order_id);
+                                      if (!order) {
+                                          return std::nullopt;
+                                      }
+                                      return PyOrder::fromOrder(mgr, *order);
+                                  }, py::arg("symbol"), py::arg("order_id"))
+        ;
+
+    //Strategies: subclass Agent in Python (call Agent.__init__) or use a native one
+    py::class_<MarketView>(m, "MarketView")
+        .def_readonly("symbol", &MarketView::symbol)
+        .def_readonly("step", &MarketView::step)
+        .def_readonly("time", &MarketView::time)
+        .def_readonly("fee_per_order", &MarketView::fee_per_order)
+        .def_readonly("fee_per_share", &MarketView::fee_per_share)
+        .def("best_bid", &MarketView::bestBid)
+        .def("best_ask", &MarketView::bestAsk)
+        .def("mid", &MarketView::mid);
+
+    py::class_<OrderSink>(m, "OrderSink")
+        .def("next_order_id", &OrderSink::nextOrderId)
+        .def("submit_order",  [](OrderSink& orders, SymbolId symbol, Side side, double price, int quantity,
+                                 OrderType type, TimeInForce tif, OrderId order_id) {
+                                  if (order_id == 0) {
+                                      order_id = orders.nextOrderId();
+                                  }
+                                  orders.submitOrder(Order(order_id, 0, symbol, side, price, quantity, type, tif));
+                                  return order_id;
+                              }, py::arg("symbol"), py::arg("side"), py::arg("price"), py::arg("quantity"),
+             py::arg("type") = OrderType::LIMIT, py::arg("tif") = TimeInForce::GTC, py::arg("order_id") = 0,
+             "Submit an order on a symbol id (e.g. market.symbol); returns its order id (next_order_id() unless given)")
+        .def("cancel_order",  &OrderSink::cancelOrder, py::arg("symbol"), py::arg("order_id"));
+
+    py::class_<Agent, PyAgent, std::shared_ptr<Agent>>(m, "Agent")
+        .def(py::init<>())
+        .def("on_step", &Agent::onStep, py::arg("market"), py::arg("orders"));
+
+    py::class_<MarketMakerAgent, Agent, std::shared_ptr<MarketMakerAgent>>(m, "MarketMakerAgent")
+        .def(py::init<double, int>(), py::arg("spread") = 1.0, py::arg("size") = 1);
+
+    py::class_<TrendFollowerAgent, Agent, std::shared_ptr<TrendFollowerAgent>>(m, "TrendFollowerAgent")
+        .def(py::init<int, double, int>(), py::arg("lookback") = 3, py::arg("threshold") = 0.002, py::arg("size") = 1);
+
+    py::class_<MeanReverterAgent, Agent, std::shared_ptr<MeanReverterAgent>>(m, "MeanReverterAgent")
+        .def(py::init<int, double, int>(), py::arg("lookback") = 10, py::arg("threshold") = 0.005, py::arg("size") = 1);
+
+    py::class_<LiquidityTakerAgent, Agent, std::shared_ptr<LiquidityTakerAgent>>(m, "LiquidityTakerAgent")
+        .def(py::init<double, int, int, uint64_t>(), py::arg("order_prob") = 0.1,
+             py::arg("min_size") = 1, py::arg("max_size") = 5, py::arg("seed") = 0);
+
+    //Native main loop; Python only runs inside Python agents' on_step
+    py::class_<SimulationConfig>(m, "SimulationConfig")
+        .def(py::init<>())
+        .def_readwrite("symbols", &SimulationConfig::symbols)
+        .def_readwrite("tick_size", &SimulationConfig::tick_size)
+        .def_readwrite("num_steps", &SimulationConfig::num_steps)
+        .def_readwrite("dt", &SimulationConfig::dt)
+        .def_readwrite("fee_per_order", &SimulationConfig::fee_per_order)
+        .def_readwrite("fee_per_share", &SimulationConfig::fee_per_share)
+        .def_readwrite("latency_mean", &SimulationConfig::latency_mean)
+        .def_readwrite("latency_std", &SimulationConfig::latency_std)
+        .def_readwrite("fund_volatility", &SimulationConfig::fund_volatility)
+        .def_readwrite("initial_mid", &SimulationConfig::initial_mid)
+        .def_readwrite("fund_half_spread", &SimulationConfig::fund_half_spread)
+        .def_readwrite("fund_quantity", &SimulationConfig::fund_quantity)
+        .def_readwrite("seed_levels", &SimulationConfig::seed_levels)
+        .def_readwrite("seed_tick", &SimulationConfig::seed_tick)
+        .def_readwrite("seed_quantity", &SimulationConfig::seed_quantity)
+        .def_readwrite("record_interval", &SimulationConfig::record_interval)
+        .def_readwrite("record_trades", &SimulationConfig::record_trades)
+        .def_readwrite("seed", &SimulationConfig::seed);
+
+    py::class_<Simulation>(m, "Simulation",
+                           "Not thread-safe: do not call into a Simulation from other threads while it runs")
+        .def(py::init<SimulationConfig>(), py::arg("config") = SimulationConfig())
+        .def("add_agent",         [](Simulation& sim, const std::string& name, const std::string& symbol,
+                                     std::shared_ptr<Agent> agent) {
+                                      return sim.addAgent(name, sim.getSymbolId(symbol), std::move(agent));
+                                  }, py::arg("name"), py::arg("symbol"), py::arg("agent"), py::keep_alive<1, 4>(),
+             "Register an Agent trading `symbol`; returns its agent id")
+        .def("run",               &Simulation::run, py::call_guard<py::gil_scoped_release>())
+        .def("step",              &Simulation::step, py::call_guard<py::gil_scoped_release>())
+        .def("submit_order",      [](Simulation& sim, AgentId agent, const PyOrder& order) {
+                                      sim.submitOrder(agent, order.toOrder(sim.getManager()));
+                                  }, py::arg("agent"), py::arg("order"),
+             "Queue an order to arrive after the sampled latency; charges the per-order fee")
+        .def("cancel_order",      [](Simulation& sim, const std::string& symbol, const std::string& order_id) {
+                                      OrderId id;
+                                      return sim.getManager().findOrderId(order_id, id) //Unknown id: nothing to cancel
+                                          && sim.cancelOrder(sim.getSymbolId(symbol), id);
+                                  }, py::arg("symbol"), py::arg("order_id"))
+        .def("get_best_bid",      [](const Simulation& sim, const std::string& symbol) {
+                                      return sim.getBestBid(sim.getSymbolId(symbol));
+                                  }, py::arg("symbol"))
+        .def("get_best_ask",      [](const Simulation& sim, const std::string& symbol) {
+                                      return sim.getBestAsk(sim.getSymbolId(symbol));
+                                  }, py::arg("symbol"))
+        .def("get_fundamental_mid", [](const Simulation& sim, const std::string& symbol) {
+                                      return sim.getFundamentalMid(sim.getSymbolId(symbol));
+                                  }, py::arg("symbol"))
+        .def("now",               &Simulation::now)
+        .def("current_step",      &Simulation::currentStep)
+        .def("agent_count",       &Simulation::agentCount)
+        .def("orders_submitted",  &Simulation::ordersSubmitted)
+        .def("orders_rejected",   &Simulation::ordersRejected)
+        .def("trade_count",       &Simulation::tradeCount)
+        .def("accounts",          &simulationAccounts, "Per-agent name, symbol, pnl, inventory and trades")
+        .def("history",           &simulationHistory, "Recorded step, pnl, inventory and nav (steps x agents)")
+        .def("trades",            &Simulation::trades, py::return_value_policy::reference_internal,
+             "Every trade so far as a TradeTape (empty unless config.record_trades)")
+        .def("trade_steps",       [](const Simulation& sim) { return toArray(sim.tradeSteps()); },
+             "Step of each recorded trade, row for row with trades()")
+        .def("intern_order_id",   [](Simulation& sim, const std::string& order_id) {
+                                      return sim.getManager().internOrderId(order_id);
+                                  }, py::arg("order_id"), "Engine id for a string order id, e.g. for OrderSink.submit_order")
+        .def("get_order_id_name", [](const Simulation& sim, OrderId order_id) {
+                                      return sim.getManager().getOrderIdName(order_id);
+                                  }, py::arg("order_id"), "The string an id was interned from, else the number itself")
         ;
+
+    //Parameter sweeps: native agents only, so no run ever needs the GIL
+    py::class_<AgentMix>(m, "AgentMix")
+        .def(py::init<>())
+        .def_readwrite("market_makers", &AgentMix::market_makers)
+        .def_readwrite("market_maker_spread", &AgentMix::market_maker_spread)
+        .def_readwrite("market_maker_size", &AgentMix::market_maker_size)
+        .def_readwrite("trend_followers", &AgentMix::trend_followers)
+        .def_readwrite("mean_reverters", &AgentMix::mean_reverters)
+        .def_readwrite("liquidity_takers", &AgentMix::liquidity_takers)
+        .def_readwrite("liquidity_taker_prob", &AgentMix::liquidity_taker_prob);
+
+    py::class_<Scenario>(m, "Scenario")
+        .def(py::init<>())
+        .def(py::init([](const SimulationConfig& config, const AgentMix& agents) { return Scenario{config, agents}; }),
+             py::arg("config"), py::arg("agents") = AgentMix())
+        .def_readwrite("config", &Scenario::config)
+        .def_readwrite("agents", &Scenario::agents);
+
+    m.def("run_monte_carlo", &runMonteCarloSweep, py::arg("scenarios"), py::arg("seeds"), py::arg("threads") = 0,
+          "Run every scenario once per seed in parallel; returns one NumPy column per summary metric");
+
+    py::class_<VecEnvConfig>(m, "VecEnvConfig")
+        .def(py::init<>())
+        .def_readwrite("simulation", &VecEnvConfig::simulation)
+        .def_readwrite("background", &VecEnvConfig::background)
+        .def_readwrite("episode_length", &VecEnvConfig::episode_length)
+        .def_readwrite("order_size", &VecEnvConfig::order_size);
+
+    py::class_<VecEnv>(m, "VecEnv")
+        .def(py::init<VecEnvConfig, size_t, size_t, bool>(), py::arg("config"), py::arg("num_envs"),
+             py::arg("threads") = 1, py::arg("pin_threads") = false)
+        .def("reset",             [](py::object self, const Column<uint64_t>& seeds) {
+                                      VecEnv& env = self.cast<VecEnv&>();
+                                      requireEnvRows(env, seeds, "seeds");
+                                      {
+                                          py::gil_scoped_release release;
+                                          env.reset(seeds.data());
+                                      }
+                                      return vecEnvOutputs(self)[0];
+                                  }, py::arg("seeds"), "Start a new episode in every env; returns the observations")
+        .def("step",              [](py::object self, const Column<int32_t>& actions) {
+                                      VecEnv& env = self.cast<VecEnv&>();
+                                      requireEnvRows(env, actions, "actions");
+                                      {
+                                          py::gil_scoped_release release;
+                                          env.step(actions.data());
+                                      }
+                                      return vecEnvOutputs(self);
+                                  }, py::arg("actions"),
+             "Apply one action per env (0 hold, 1 buy, 2 sell); returns (observations, rewards, dones)")
+        .def_property_readonly("num_envs", &VecEnv::size)
+        .def_property_readonly_static("observation_dim", [](py::object) { return VecEnv::OBSERVATION_DIM; })
+        .def_property_readonly_static("action_count", [](py::object) { return 3; });
 }